@@ -0,0 +1,145 @@
+// 无窗口的演化实验, 不限帧率地过日子, 把每天的种群和基因写成 CSV, 通宵的实验几分钟就能跑完
+#include "digitama/JrLab/dewdney/headless.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+using namespace JrLab;
+
+/*************************************************************************************************/
+namespace {
+    enum class BatchOps { Days, Size, Founders, Interval, Log, Seed, _ };
+
+    struct BatchOptions {
+        std::string log;
+        int days = 10000;
+        int row = 24;
+        int col = 36;
+        int founders = 1;
+        int interval = 1;
+        uint64_t seed = 0U;
+        bool seeded = false;
+    };
+
+    void print_usage(const char* program) {
+        printf("Usage: %s [options]\n", program);
+        printf("  --days N          number of days to run (default: 10000)\n");
+        printf("  --size RxC        steppe size (default: 24x36)\n");
+        printf("  --founders N      initial animals of each species (default: 1)\n");
+        printf("  --interval K      log a census every K days (default: 1)\n");
+        printf("  --log PATH        write the census to PATH, - for stdout\n");
+        printf("  --seed S          replay the run seeded with S (default: random)\n");
+    }
+
+    bool parse_cmdline_options(int argc, char* argv[], BatchOptions& options) {
+        BatchOps opt = BatchOps::_;
+        bool okay = true;
+
+        for (int idx = 1; idx < argc; idx ++) {
+            switch (opt) {
+            case BatchOps::Days: options.days = std::atoi(argv[idx]); opt = BatchOps::_; break;
+            case BatchOps::Founders: options.founders = std::atoi(argv[idx]); opt = BatchOps::_; break;
+            case BatchOps::Interval: options.interval = std::atoi(argv[idx]); opt = BatchOps::_; break;
+            case BatchOps::Log: options.log = argv[idx]; opt = BatchOps::_; break;
+            case BatchOps::Seed: options.seed = std::strtoull(argv[idx], nullptr, 0); options.seeded = true; opt = BatchOps::_; break;
+            case BatchOps::Size: {
+                if (sscanf(argv[idx], "%dx%d", &options.row, &options.col) != 2) {
+                    options.row = 0;
+                    options.col = 0;
+                }
+
+                opt = BatchOps::_;
+            }; break;
+            default: {
+                if (strncmp("--days", argv[idx], 7) == 0) {
+                    opt = BatchOps::Days;
+                } else if (strncmp("--size", argv[idx], 7) == 0) {
+                    opt = BatchOps::Size;
+                } else if (strncmp("--founders", argv[idx], 11) == 0) {
+                    opt = BatchOps::Founders;
+                } else if (strncmp("--interval", argv[idx], 11) == 0) {
+                    opt = BatchOps::Interval;
+                } else if (strncmp("--log", argv[idx], 6) == 0) {
+                    opt = BatchOps::Log;
+                } else if (strncmp("--seed", argv[idx], 7) == 0) {
+                    opt = BatchOps::Seed;
+                } else {
+                    okay = false;
+                }
+            }
+            }
+        }
+
+        // 丛林占 8x6 格, 草原至少要装得下它
+        return okay && (options.days > 0) && (options.row >= 10) && (options.col >= 8) && (options.founders > 0);
+    }
+}
+
+/*************************************************************************************************/
+int main(int argc, char* argv[]) {
+    BatchOptions options;
+    std::ofstream logout;
+    std::ostream* log = nullptr;
+    SteppeRunReport report;
+
+    if (!parse_cmdline_options(argc, argv, options)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    if (options.log == "-") {
+        log = &std::cout;
+    } else if (!options.log.empty()) {
+        logout.open(options.log);
+
+        if (!logout.is_open()) {
+            printf("Failed to open the log: %s\n", options.log.c_str());
+            return 1;
+        }
+
+        log = &logout;
+    }
+
+    // 没给种子就随机选一个, 打印出来以便重放
+    if (!options.seeded) {
+        options.seed = RandomStream().next();
+    }
+
+    set_random_master_seed(options.seed);
+
+    // 日志占用了标准输出时种子改打到标准错误, 不然就没法重放了
+    if (log == &std::cout) {
+        fprintf(stderr, "seed: %llu\n", (unsigned long long)(options.seed));
+    }
+
+    /* 草原和种群只当作数据结构使用, 不需要绘图上下文 */
+    SteppeField field(options.row, options.col);
+    SteppePopulation population(options.row, options.col);
+
+    for (int idx = 0; idx < options.founders; idx ++) {
+        for (size_t s = 0; s < size_t(SteppeSpecies::_); s ++) {
+            population.spawn(SteppeSpecies(s));
+        }
+    }
+
+    report = run_steppe_days(&field, &population, options.days, log, options.interval);
+
+    if (log != &std::cout) {
+        printf("steppe: %d x %d\n", options.row, options.col);
+        printf("founders: %d per species\n", options.founders);
+        printf("seed: %llu\n", (unsigned long long)(options.seed));
+        printf("days: %d%s\n", report.days, report.extinct ? " (extinct)" : "");
+        printf("seconds: %.6f\n", report.seconds);
+
+        if (report.seconds > 0.0) {
+            printf("days/s: %.2f\n", double(report.days) / report.seconds);
+        }
+
+        printf("survivors: %d\n", report.survivors);
+    }
+
+    return 0;
+}
@@ -0,0 +1,171 @@
+// 演化实验的参数扫描: 在所有的 CPU 核上跑遍繁殖周期, 能量, 丛林大小和变异步长的组合, 汇总成一张报告
+#include "digitama/JrLab/dewdney/sweep.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace JrLab;
+
+/*************************************************************************************************/
+namespace {
+    enum class SweepOps { Days, Size, Founders, Replicates, Seed, Threads, Cycles, Energies, Jungles, Mutations, Output, _ };
+
+    struct SweepOptions {
+        std::string output = "sweep.csv";
+        SteppeSweepOptions sweep;
+    };
+
+    void print_usage(const char* program) {
+        printf("Usage: %s [options]\n", program);
+        printf("  --days N              days of each run (default: 10000)\n");
+        printf("  --size RxC            steppe size (default: 24x36)\n");
+        printf("  --founders N          initial animals of each species (default: 1)\n");
+        printf("  --replicates N        independent runs of each configuration (default: 8)\n");
+        printf("  --seed S              seed of the whole sweep (default: 0)\n");
+        printf("  --threads T           simulating threads, 0 for all cores (default: 0)\n");
+        printf("  --cycles P,...        breeding cycles in percent of the defaults (default: 100)\n");
+        printf("  --energies P,...      full energies in percent of the defaults (default: 100)\n");
+        printf("  --jungles RxC,...     jungle sizes (default: 8x6)\n");
+        printf("  --mutations M,...     maximum change of a gene per mutation, >= 0 (default: 1)\n");
+        printf("  --output PATH         where to write the report (default: sweep.csv)\n");
+    }
+
+    bool parse_int_list(const char* arg, std::vector<int>& values, int min_value) {
+        std::stringstream s(arg);
+        std::string item;
+
+        values.clear();
+        while (std::getline(s, item, ',')) {
+            int v = std::atoi(item.c_str());
+
+            // 负的变异步长或者不是正数的百分比会让模拟悄悄地跑出无意义的结果, 直接拒绝
+            if (v < min_value) {
+                return false;
+            }
+
+            values.push_back(v);
+        }
+
+        return !values.empty();
+    }
+
+    bool parse_size_list(const char* arg, std::vector<std::pair<int, int>>& values) {
+        std::stringstream s(arg);
+        std::string item;
+
+        values.clear();
+        while (std::getline(s, item, ',')) {
+            int r = 0;
+            int c = 0;
+
+            if ((sscanf(item.c_str(), "%dx%d", &r, &c) != 2) || (r <= 0) || (c <= 0)) {
+                return false;
+            }
+
+            values.push_back({ r, c });
+        }
+
+        return !values.empty();
+    }
+
+    bool parse_cmdline_options(int argc, char* argv[], SweepOptions& options) {
+        SteppeSweepOptions& sweep = options.sweep;
+        SweepOps opt = SweepOps::_;
+        bool okay = true;
+
+        for (int idx = 1; idx < argc; idx ++) {
+            switch (opt) {
+            case SweepOps::Days: sweep.days = std::atoi(argv[idx]); opt = SweepOps::_; break;
+            case SweepOps::Founders: sweep.founders = std::atoi(argv[idx]); opt = SweepOps::_; break;
+            case SweepOps::Replicates: sweep.replicates = std::atoi(argv[idx]); opt = SweepOps::_; break;
+            case SweepOps::Seed: sweep.seed = std::strtoull(argv[idx], nullptr, 0); opt = SweepOps::_; break;
+            case SweepOps::Threads: sweep.threads = std::atoi(argv[idx]); opt = SweepOps::_; break;
+            case SweepOps::Cycles: okay = okay && parse_int_list(argv[idx], sweep.cycle_percents, 1); opt = SweepOps::_; break;
+            case SweepOps::Energies: okay = okay && parse_int_list(argv[idx], sweep.energy_percents, 1); opt = SweepOps::_; break;
+            case SweepOps::Jungles: okay = okay && parse_size_list(argv[idx], sweep.jungles); opt = SweepOps::_; break;
+            case SweepOps::Mutations: okay = okay && parse_int_list(argv[idx], sweep.mutation_steps, 0); opt = SweepOps::_; break;
+            case SweepOps::Output: options.output = argv[idx]; opt = SweepOps::_; break;
+            case SweepOps::Size: {
+                if (sscanf(argv[idx], "%dx%d", &sweep.row, &sweep.col) != 2) {
+                    sweep.row = 0;
+                    sweep.col = 0;
+                }
+
+                opt = SweepOps::_;
+            }; break;
+            default: {
+                if (strncmp("--days", argv[idx], 7) == 0) {
+                    opt = SweepOps::Days;
+                } else if (strncmp("--size", argv[idx], 7) == 0) {
+                    opt = SweepOps::Size;
+                } else if (strncmp("--founders", argv[idx], 11) == 0) {
+                    opt = SweepOps::Founders;
+                } else if (strncmp("--replicates", argv[idx], 13) == 0) {
+                    opt = SweepOps::Replicates;
+                } else if (strncmp("--seed", argv[idx], 7) == 0) {
+                    opt = SweepOps::Seed;
+                } else if (strncmp("--threads", argv[idx], 10) == 0) {
+                    opt = SweepOps::Threads;
+                } else if (strncmp("--cycles", argv[idx], 9) == 0) {
+                    opt = SweepOps::Cycles;
+                } else if (strncmp("--energies", argv[idx], 11) == 0) {
+                    opt = SweepOps::Energies;
+                } else if (strncmp("--jungles", argv[idx], 10) == 0) {
+                    opt = SweepOps::Jungles;
+                } else if (strncmp("--mutations", argv[idx], 12) == 0) {
+                    opt = SweepOps::Mutations;
+                } else if (strncmp("--output", argv[idx], 9) == 0) {
+                    opt = SweepOps::Output;
+                } else {
+                    okay = false;
+                }
+            }
+            }
+        }
+
+        return okay && (sweep.days > 0) && (sweep.row > 0) && (sweep.col > 0) && (sweep.founders > 0);
+    }
+}
+
+/*************************************************************************************************/
+int main(int argc, char* argv[]) {
+    SweepOptions options;
+    SteppeSweepReport report;
+    std::ofstream sweepout;
+
+    if (!parse_cmdline_options(argc, argv, options)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    report = run_steppe_sweep(options.sweep);
+
+    sweepout.open(options.output);
+    if (sweepout.is_open()) {
+        write_steppe_sweep(sweepout, report);
+    } else {
+        printf("Failed to write the report: %s\n", options.output.c_str());
+    }
+
+    printf("configurations: %d\n", int(report.table.size()));
+    printf("runs: %lld\n", report.runs);
+    printf("seconds: %.6f\n", report.seconds);
+
+    if (report.seconds > 0.0) {
+        printf("runs/s: %.2f\n", double(report.runs) / report.seconds);
+    }
+
+    for (auto& entry : report.table) {
+        printf("cycle %3d%%  energy %3d%%  jungle %dx%d  mutation %d:  %d/%d extinct, %.1f days\n",
+            entry.config.cycle_percent, entry.config.energy_percent,
+            entry.config.jungle_row, entry.config.jungle_col, entry.config.mutation_step,
+            entry.extinctions, entry.runs, entry.mean_days);
+    }
+
+    return 0;
+}
@@ -0,0 +1,161 @@
+// 无窗口的生命游戏批量演化器, 用来测量吞吐量和给部署环境估算棋盘大小
+#include "digitama/JrLab/conway/headless.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace JrLab;
+
+/*************************************************************************************************/
+namespace {
+    enum class BatchOps { Generations, Engine, Rule, Topology, Jump, Threads, Size, Dump, _ };
+
+    struct BatchOptions {
+        std::string pattern;
+        std::string engine;
+        std::string rule;
+        std::string topology;
+        std::string dump;
+        long long generations = 1000;
+        int jump = 0;
+        int threads = 1;
+        int row = 0;
+        int col = 0;
+    };
+
+    void print_usage(const char* program) {
+        printf("Usage: %s [options] <pattern.gof|pattern.rle>\n", program);
+        printf("  --generations N   number of generations to run (default: 1000)\n");
+        printf("  --engine NAME     bitwise, hashlife, or empty for the int matrix\n");
+        printf("  --rule RULE       B/S rulestring or a rule name (default: B3/S23)\n");
+        printf("  --topology NAME   dead, torus, or klein (default: dead)\n");
+        printf("  --jump J          hashlife advances 2^J generations per step, 0 <= J <= 62\n");
+        printf("  --threads T       evolving threads, 0 for all cores (default: 1)\n");
+        printf("  --size RxC        board size, defaults to the size of the pattern\n");
+        printf("  --dump PATH       write the final board, .rle or .gof by extension\n");
+    }
+
+    bool parse_cmdline_options(int argc, char* argv[], BatchOptions& options) {
+        BatchOps opt = BatchOps::_;
+
+        for (int idx = 1; idx < argc; idx ++) {
+            switch (opt) {
+            case BatchOps::Generations: options.generations = std::atoll(argv[idx]); opt = BatchOps::_; break;
+            case BatchOps::Engine: options.engine = argv[idx]; opt = BatchOps::_; break;
+            case BatchOps::Rule: options.rule = argv[idx]; opt = BatchOps::_; break;
+            case BatchOps::Topology: options.topology = argv[idx]; opt = BatchOps::_; break;
+            case BatchOps::Jump: options.jump = std::atoi(argv[idx]); opt = BatchOps::_; break;
+            case BatchOps::Threads: options.threads = std::atoi(argv[idx]); opt = BatchOps::_; break;
+            case BatchOps::Dump: options.dump = argv[idx]; opt = BatchOps::_; break;
+            case BatchOps::Size: {
+                if (sscanf(argv[idx], "%dx%d", &options.row, &options.col) != 2) {
+                    options.row = 0;
+                    options.col = 0;
+                }
+
+                opt = BatchOps::_;
+            }; break;
+            default: {
+                if (strncmp("--generations", argv[idx], 14) == 0) {
+                    opt = BatchOps::Generations;
+                } else if (strncmp("--engine", argv[idx], 9) == 0) {
+                    opt = BatchOps::Engine;
+                } else if (strncmp("--rule", argv[idx], 7) == 0) {
+                    opt = BatchOps::Rule;
+                } else if (strncmp("--topology", argv[idx], 11) == 0) {
+                    opt = BatchOps::Topology;
+                } else if (strncmp("--jump", argv[idx], 7) == 0) {
+                    opt = BatchOps::Jump;
+                } else if (strncmp("--threads", argv[idx], 10) == 0) {
+                    opt = BatchOps::Threads;
+                } else if (strncmp("--size", argv[idx], 7) == 0) {
+                    opt = BatchOps::Size;
+                } else if (strncmp("--dump", argv[idx], 7) == 0) {
+                    opt = BatchOps::Dump;
+                } else {
+                    options.pattern = argv[idx];
+                }
+            }
+            }
+        }
+
+        return !options.pattern.empty() && (options.jump >= 0) && (options.jump <= hashlife_max_jump);
+    }
+}
+
+/*************************************************************************************************/
+int main(int argc, char* argv[]) {
+    BatchOptions options;
+    LifeRule rule = conway_rule;
+    LifeTopology topology = LifeTopology::Dead;
+    GameOfLifelet* board = nullptr;
+    LifeRunReport report;
+
+    if (!parse_cmdline_options(argc, argv, options)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    if ((!options.rule.empty()) && !parse_life_rule(options.rule, &rule)) {
+        printf("Invalid rule: %s\n", options.rule.c_str());
+        return 1;
+    }
+
+    if ((!options.topology.empty()) && !parse_life_topology(options.topology, &topology)) {
+        printf("Invalid topology: %s\n", options.topology.c_str());
+        return 1;
+    }
+
+    if ((options.row <= 0) || (options.col <= 0)) {
+        if (!probe_life_pattern(options.pattern, &options.row, &options.col)) {
+            printf("Failed to probe the pattern: %s\n", options.pattern.c_str());
+            return 1;
+        }
+    }
+
+    /* 棋盘只当作数据结构使用, 不需要绘图上下文 */
+    board = make_game_of_lifelet(options.engine, rule, options.row, options.col, 1.0F, options.jump, topology);
+    board->construct(nullptr);
+    board->set_thread_count(options.threads);
+
+    try {
+        load_life_pattern(board, options.pattern);
+    } catch (std::ios_base::failure& e) {
+        printf("Failed to load the pattern: %s\n", e.what());
+        delete board;
+        return 1;
+    }
+
+    report = run_life_generations(board, options.generations);
+
+    printf("pattern: %s\n", options.pattern.c_str());
+    printf("board: %d x %d\n", options.row, options.col);
+    printf("engine: %s\n", options.engine.empty() ? "matrix" : options.engine.c_str());
+    printf("rule: %s\n", life_rule_to_string(board->get_rule()).c_str());
+    printf("topology: %s\n", life_topology_name(board->get_topology()));
+    printf("threads: %d\n", options.threads);
+    printf("generations: %lld%s\n", report.generations, report.stabilized ? " (stabilized)" : "");
+    printf("seconds: %.6f\n", report.seconds);
+
+    if (report.seconds > 0.0) {
+        double gps = double(report.generations) / report.seconds;
+
+        printf("generations/s: %.2f\n", gps);
+        printf("cell updates/s: %.2f\n", gps * double(options.row) * double(options.col));
+    }
+
+    printf("population: %lld\n", report.population);
+
+    if (!options.dump.empty()) {
+        try {
+            save_life_pattern(board, options.dump);
+        } catch (std::ios_base::failure& e) {
+            printf("Failed to dump the board: %s\n", e.what());
+        }
+    }
+
+    delete board;
+
+    return 0;
+}
@@ -0,0 +1,365 @@
+// 生命游戏演化引擎的基准测试: 遍历范例图案, 比较各引擎的速度和内存, 并交叉验证演化结果
+#include "digitama/JrLab/conway/headless.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace JrLab;
+using namespace std::filesystem;
+
+/*************************************************************************************************/
+namespace {
+    enum class BenchOps { Directory, Sizes, Threads, Rules, Engines, Generations, Repeats, Checks, _ };
+
+    struct BenchOptions {
+        std::string directory = "stone/demo/conway";
+        std::vector<std::string> sizes { "256", "1024" };
+        std::vector<std::string> threads { "1", "0" };
+        std::vector<std::string> rules { "conway", "highlife", "seeds", "daynight", "brain" };
+        std::vector<std::string> engines { "matrix", "rule", "bitwise", "hashlife" };
+        std::vector<std::string> checks { "1", "10", "100" };
+        long long generations = 100;
+        int repeats = 5;
+    };
+
+    struct LifePattern {
+        std::string name;
+        std::vector<std::string> rows;  // 每个字符是一个细胞, '0' 或 '1'
+        int width = 0;
+    };
+
+    std::vector<std::string> split_list(const char* arg) {
+        std::vector<std::string> items;
+        std::stringstream ss(arg);
+        std::string item;
+
+        while (std::getline(ss, item, ',')) {
+            if (!item.empty()) {
+                items.push_back(item);
+            }
+        }
+
+        return items;
+    }
+
+    bool parse_cmdline_options(int argc, char* argv[], BenchOptions& options) {
+        BenchOps opt = BenchOps::_;
+
+        for (int idx = 1; idx < argc; idx ++) {
+            switch (opt) {
+            case BenchOps::Directory: options.directory = argv[idx]; opt = BenchOps::_; break;
+            case BenchOps::Sizes: options.sizes = split_list(argv[idx]); opt = BenchOps::_; break;
+            case BenchOps::Threads: options.threads = split_list(argv[idx]); opt = BenchOps::_; break;
+            case BenchOps::Rules: options.rules = split_list(argv[idx]); opt = BenchOps::_; break;
+            case BenchOps::Engines: options.engines = split_list(argv[idx]); opt = BenchOps::_; break;
+            case BenchOps::Checks: options.checks = split_list(argv[idx]); opt = BenchOps::_; break;
+            case BenchOps::Generations: options.generations = std::atoll(argv[idx]); opt = BenchOps::_; break;
+            case BenchOps::Repeats: options.repeats = std::atoi(argv[idx]); opt = BenchOps::_; break;
+            default: {
+                if (strncmp("--patterns", argv[idx], 11) == 0) {
+                    opt = BenchOps::Directory;
+                } else if (strncmp("--sizes", argv[idx], 8) == 0) {
+                    opt = BenchOps::Sizes;
+                } else if (strncmp("--threads", argv[idx], 10) == 0) {
+                    opt = BenchOps::Threads;
+                } else if (strncmp("--rules", argv[idx], 8) == 0) {
+                    opt = BenchOps::Rules;
+                } else if (strncmp("--engines", argv[idx], 10) == 0) {
+                    opt = BenchOps::Engines;
+                } else if (strncmp("--checks", argv[idx], 9) == 0) {
+                    opt = BenchOps::Checks;
+                } else if (strncmp("--generations", argv[idx], 14) == 0) {
+                    opt = BenchOps::Generations;
+                } else if (strncmp("--repeats", argv[idx], 10) == 0) {
+                    opt = BenchOps::Repeats;
+                } else {
+                    printf("Usage: %s [--patterns DIR] [--sizes N,...] [--threads T,...] [--rules R,...]\n"
+                           "          [--engines matrix,rule,bitwise,hashlife] [--generations G] [--repeats K] [--checks G,...]\n",
+                           argv[0]);
+                    return false;
+                }
+            }
+            }
+        }
+
+        return (options.repeats > 0) && (options.generations > 0);
+    }
+
+    /*********************************************************************************************/
+    GameOfLifelet* make_board(const std::string& engine, const LifeRule& rule, int row, int col, int threads) {
+        GameOfLifelet* board = make_game_of_lifelet((engine == "matrix") ? "" : engine, rule, row, col, 1.0F);
+
+        board->construct(nullptr);
+        board->set_thread_count(threads);
+
+        return board;
+    }
+
+    std::string save_board(GameOfLifelet* board) {
+        std::ostringstream golout;
+
+        board->save("", golout);
+
+        return golout.str();
+    }
+
+    // 两种格式都先载入一块和图案一样大的棋盘, 再借 .gof 的写出格式拿到每个细胞
+    bool read_pattern(const path& file, LifePattern& pattern) {
+        GameOfLifelet* board = nullptr;
+        int row, col;
+        bool okay = false;
+
+        if (probe_life_pattern(file.string(), &row, &col)) {
+            std::istringstream golin;
+            std::string rowline;
+
+            board = make_board("matrix", conway_rule, row, col, 1);
+
+            try {
+                load_life_pattern(board, file.string());
+                golin.str(save_board(board));
+
+                while (std::getline(golin, rowline)) {
+                    pattern.rows.push_back(rowline);
+                }
+
+                pattern.name = file.filename().string();
+                pattern.width = col;
+                okay = true;
+            } catch (std::ios_base::failure& e) {
+                fprintf(stderr, "Failed to load the pattern %s: %s\n", file.string().c_str(), e.what());
+            }
+
+            delete board;
+        }
+
+        return okay;
+    }
+
+    // 把图案平铺到 row x col 的棋盘上
+    std::string tile_pattern(const LifePattern& pattern, int row, int col) {
+        std::string gof;
+
+        gof.reserve(size_t(row) * size_t(col + 1));
+
+        for (int r = 0; r < row; r ++) {
+            const std::string& src = pattern.rows[size_t(r) % pattern.rows.size()];
+
+            for (int c = 0; c < col; c ++) {
+                gof.push_back(src[size_t(c % pattern.width)]);
+            }
+
+            gof.push_back('\n');
+        }
+
+        return gof;
+    }
+
+    // 四周各留出 margin 格空白, 细胞最快每代扩张一格, 演化 margin 代之内都碰不到边界
+    std::string pad_pattern(const LifePattern& pattern, int margin, int* row, int* col) {
+        std::string gof;
+
+        (*row) = int(pattern.rows.size()) + margin * 2;
+        (*col) = pattern.width + margin * 2;
+
+        for (int r = 0; r < (*row); r ++) {
+            int pr = r - margin;
+
+            for (int c = 0; c < (*col); c ++) {
+                int pc = c - margin;
+                bool alive = (pr >= 0) && (pr < int(pattern.rows.size()))
+                    && (pc >= 0) && (pc < int(pattern.rows[pr].size()))
+                    && (pattern.rows[pr][pc] == '1');
+
+                gof.push_back(alive ? '1' : '0');
+            }
+
+            gof.push_back('\n');
+        }
+
+        return gof;
+    }
+
+    void load_board(GameOfLifelet* board, const std::string& gof) {
+        std::istringstream golin(gof);
+
+        board->load("", golin);
+    }
+
+    /*********************************************************************************************/
+    // 无界的 hashlife 只有在碰不到边界时才和其他引擎一致, 所以交叉验证在留足空白的棋盘上进行
+    bool cross_check(const BenchOptions& options, const LifePattern& pattern, const std::string& rulename, const LifeRule& rule) {
+        std::vector<GameOfLifelet*> boards;
+        std::vector<long long> checkpoints;
+        std::string gof;
+        int row, col;
+        bool okay = true;
+
+        for (auto& g : options.checks) {
+            checkpoints.push_back(std::atoll(g.c_str()));
+        }
+
+        std::sort(checkpoints.begin(), checkpoints.end());
+
+        if (checkpoints.empty() || options.engines.size() < 2) {
+            return true;
+        }
+
+        gof = pad_pattern(pattern, int(checkpoints.back()) + 1, &row, &col);
+
+        for (auto& engine : options.engines) {
+            boards.push_back(make_board(engine, rule, row, col, 1));
+            load_board(boards.back(), gof);
+        }
+
+        for (auto checkpoint : checkpoints) {
+            std::string expected;
+
+            for (size_t idx = 0; idx < boards.size(); idx ++) {
+                std::string actual;
+
+                run_life_generations(boards[idx], checkpoint - boards[idx]->get_generation());
+                actual = save_board(boards[idx]);
+
+                if (idx == 0) {
+                    expected = actual;
+                } else if (actual != expected) {
+                    fprintf(stderr, "MISMATCH: %s %s generation %lld: %s differs from %s\n",
+                        pattern.name.c_str(), rulename.c_str(), checkpoint,
+                        options.engines[idx].c_str(), options.engines[0].c_str());
+                    okay = false;
+                }
+            }
+        }
+
+        if (okay) {
+            fprintf(stderr, "checked: %s %s\n", pattern.name.c_str(), rulename.c_str());
+        }
+
+        for (auto board : boards) {
+            delete board;
+        }
+
+        return okay;
+    }
+
+    void benchmark(const BenchOptions& options, const LifePattern& pattern, const std::string& rulename, const LifeRule& rule,
+            int size, int threads, const std::string& engine) {
+        std::string gof = tile_pattern(pattern, size, size);
+        std::vector<double> samples;
+        size_t memory = 0;
+        long long generations = 0;
+        double cells = double(size) * double(size);
+
+        for (int rep = 0; rep < options.repeats; rep ++) {
+            GameOfLifelet* board = make_board(engine, rule, size, size, threads);
+            LifeRunReport report;
+
+            load_board(board, gof);
+            report = run_life_generations(board, options.generations);
+
+            if (report.generations > 0) {
+                samples.push_back(report.seconds * 1.0e9 / (cells * double(report.generations)));
+            }
+
+            generations = report.generations;
+            memory = std::max(memory, board->get_memory_footprint());
+            delete board;
+        }
+
+        std::sort(samples.begin(), samples.end());
+
+        printf("%s,%s,%s,%d,%d,%d,%lld,", pattern.name.c_str(), rulename.c_str(), engine.c_str(),
+            size, size, threads, generations);
+
+        if (samples.empty()) {
+            printf(",,,%zu\n", memory);
+        } else {
+            printf("%.4f,%.4f,%.4f,%zu\n", samples[samples.size() / 2], samples.front(), samples.back(), memory);
+        }
+
+        fflush(stdout);
+    }
+}
+
+/*************************************************************************************************/
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    std::vector<path> files;
+    std::vector<LifePattern> patterns;
+    std::vector<int> thread_counts;
+    bool consistent = true;
+
+    if (!parse_cmdline_options(argc, argv, options)) {
+        return 1;
+    }
+
+    if (!is_directory(options.directory)) {
+        fprintf(stderr, "Not a directory: %s\n", options.directory.c_str());
+        return 1;
+    }
+
+    for (auto& entry : directory_iterator(options.directory)) {
+        if ((entry.path().extension() == ".gof") || (entry.path().extension() == ".rle")) {
+            files.push_back(entry.path());
+        }
+    }
+
+    std::sort(files.begin(), files.end());
+
+    // 0 表示所有的 CPU 核, 换算之后去掉重复的线程数
+    for (auto& t : options.threads) {
+        int threads = std::atoi(t.c_str());
+
+        if (threads <= 0) {
+            threads = int(std::thread::hardware_concurrency());
+        }
+
+        if (std::find(thread_counts.begin(), thread_counts.end(), threads) == thread_counts.end()) {
+            thread_counts.push_back(threads);
+        }
+    }
+
+    for (auto& file : files) {
+        LifePattern pattern;
+
+        if (read_pattern(file, pattern) && (pattern.width > 0)) {
+            patterns.push_back(pattern);
+        }
+    }
+
+    printf("pattern,rule,engine,rows,cols,threads,generations,median_ns_per_cell_gen,min_ns_per_cell_gen,max_ns_per_cell_gen,memory_bytes\n");
+
+    for (auto& pattern : patterns) {
+        for (auto& rulename : options.rules) {
+            LifeRule rule = conway_rule;
+
+            if (!parse_life_rule(rulename, &rule)) {
+                fprintf(stderr, "Invalid rule: %s\n", rulename.c_str());
+                continue;
+            }
+
+            consistent = cross_check(options, pattern, rulename, rule) && consistent;
+
+            for (auto& s : options.sizes) {
+                for (auto threads : thread_counts) {
+                    for (auto& engine : options.engines) {
+                        // hashlife 不分带演化, 线程数对它没有意义
+                        if ((engine != "hashlife") || (threads == thread_counts.front())) {
+                            benchmark(options, pattern, rulename, rule, std::atoi(s.c_str()), threads, engine);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return consistent ? 0 : 2;
+}
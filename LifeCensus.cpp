@@ -0,0 +1,138 @@
+// 生命游戏随机汤普查: 在所有的 CPU 核上演化成千上万锅随机汤直到稳定, 统计其中各种物体出现的频数
+#include "digitama/JrLab/conway/census.hpp"
+
+#include <fstream>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace JrLab;
+
+/*************************************************************************************************/
+namespace {
+    enum class CensusOps { Soups, Seed, Density, SoupSize, Arena, MaxGenerations, Rule, Threads, Output, Top, _ };
+
+    struct CensusOptions {
+        std::string rule;
+        std::string output = "census.csv";
+        long long soups = 1000;
+        int top = 20;
+        LifeCensusOptions census;
+    };
+
+    void print_usage(const char* program) {
+        printf("Usage: %s [options]\n", program);
+        printf("  --soups N             number of random soups (default: 1000)\n");
+        printf("  --seed S              seed of the whole census (default: 0)\n");
+        printf("  --density D           fraction of live cells in a soup (default: 0.5)\n");
+        printf("  --soup-size N         side length of a soup, at most 64 (default: 16)\n");
+        printf("  --arena N             side length of the evolving arena (default: 256)\n");
+        printf("  --max-generations G   give up soups still active after G generations (default: 20000)\n");
+        printf("  --rule RULE           B/S rulestring or a rule name (default: B3/S23)\n");
+        printf("  --threads T           evolving threads, 0 for all cores (default: 0)\n");
+        printf("  --output PATH         where to write the frequency table (default: census.csv)\n");
+        printf("  --top K               number of objects to print (default: 20)\n");
+    }
+
+    bool parse_cmdline_options(int argc, char* argv[], CensusOptions& options) {
+        CensusOps opt = CensusOps::_;
+
+        for (int idx = 1; idx < argc; idx ++) {
+            switch (opt) {
+            case CensusOps::Soups: options.soups = std::atoll(argv[idx]); opt = CensusOps::_; break;
+            case CensusOps::Seed: options.census.seed = std::strtoull(argv[idx], nullptr, 0); opt = CensusOps::_; break;
+            case CensusOps::Density: options.census.density = std::atof(argv[idx]); opt = CensusOps::_; break;
+            case CensusOps::SoupSize: options.census.soup_size = std::atoi(argv[idx]); opt = CensusOps::_; break;
+            case CensusOps::Arena: options.census.arena_size = std::atoi(argv[idx]); opt = CensusOps::_; break;
+            case CensusOps::MaxGenerations: options.census.max_generations = std::atoll(argv[idx]); opt = CensusOps::_; break;
+            case CensusOps::Rule: options.rule = argv[idx]; opt = CensusOps::_; break;
+            case CensusOps::Threads: options.census.threads = std::atoi(argv[idx]); opt = CensusOps::_; break;
+            case CensusOps::Output: options.output = argv[idx]; opt = CensusOps::_; break;
+            case CensusOps::Top: options.top = std::atoi(argv[idx]); opt = CensusOps::_; break;
+            default: {
+                if (strncmp("--soups", argv[idx], 8) == 0) {
+                    opt = CensusOps::Soups;
+                } else if (strncmp("--seed", argv[idx], 7) == 0) {
+                    opt = CensusOps::Seed;
+                } else if (strncmp("--density", argv[idx], 10) == 0) {
+                    opt = CensusOps::Density;
+                } else if (strncmp("--soup-size", argv[idx], 12) == 0) {
+                    opt = CensusOps::SoupSize;
+                } else if (strncmp("--arena", argv[idx], 8) == 0) {
+                    opt = CensusOps::Arena;
+                } else if (strncmp("--max-generations", argv[idx], 18) == 0) {
+                    opt = CensusOps::MaxGenerations;
+                } else if (strncmp("--rule", argv[idx], 7) == 0) {
+                    opt = CensusOps::Rule;
+                } else if (strncmp("--threads", argv[idx], 10) == 0) {
+                    opt = CensusOps::Threads;
+                } else if (strncmp("--output", argv[idx], 9) == 0) {
+                    opt = CensusOps::Output;
+                } else if (strncmp("--top", argv[idx], 6) == 0) {
+                    opt = CensusOps::Top;
+                } else {
+                    return false;
+                }
+            }
+            }
+        }
+
+        return (options.soups > 0)
+            && (options.census.soup_size > 0) && (options.census.soup_size <= 64)
+            && (options.census.arena_size >= options.census.soup_size + 64)
+            && (options.census.density >= 0.0) && (options.census.density <= 1.0);
+    }
+}
+
+/*************************************************************************************************/
+int main(int argc, char* argv[]) {
+    CensusOptions options;
+    LifeCensusReport report;
+    std::ofstream csv;
+
+    if (!parse_cmdline_options(argc, argv, options)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    if ((!options.rule.empty()) && !parse_life_rule(options.rule, &options.census.rule)) {
+        printf("Invalid rule: %s\n", options.rule.c_str());
+        return 1;
+    }
+
+    if (options.census.rule.states > 2) {
+        printf("Generations rules are not supported by the census: %s\n", options.rule.c_str());
+        return 1;
+    }
+
+    report = run_life_census(options.census, options.soups);
+
+    printf("rule: %s\n", life_rule_to_string(options.census.rule).c_str());
+    printf("soups: %lld (%lld stabilized)\n", report.soups, report.stabilized);
+    printf("generations: %lld\n", report.generations);
+    printf("objects: %lld\n", report.objects);
+    printf("seconds: %.6f\n", report.seconds);
+
+    if (report.seconds > 0.0) {
+        printf("soups/s: %.2f\n", double(report.soups) / report.seconds);
+    }
+
+    for (int idx = 0; (idx < options.top) && (idx < int(report.table.size())); idx ++) {
+        const LifeCensusEntry& entry = report.table[idx];
+
+        printf("%12lld  %s%s%s\n", entry.count, entry.code.c_str(),
+            entry.name.empty() ? "" : "  ", entry.name.c_str());
+    }
+
+    csv.open(options.output);
+
+    if (!csv.is_open()) {
+        printf("Failed to write the census: %s\n", options.output.c_str());
+        return 1;
+    }
+
+    write_life_census(csv, report);
+
+    return 0;
+}
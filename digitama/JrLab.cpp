@@ -13,6 +13,8 @@
 #include "JrLab/game_of_life.hpp"         // 生命游戏
 #include "JrLab/evolution.hpp"            // 演化游戏
 
+#include "JrLab/random/stream.hpp"
+
 // 导入教师演示程序
 #include <pltmos/stream.hpp>
 #include <pltmos/carry.hpp>
@@ -46,7 +48,7 @@ void JrLab::JrLabCosmos::construct(int argc, char* argv[]) {
             
     // 第三阶段
     this->spawn<SelfAvoidingWalkWorld>();
-    this->spawn<GameOfLifeWorld>(this->life_source);
+    this->spawn<GameOfLifeWorld>(this->life);
 
 #ifdef __windows__
     this->spawn<TheBigBang>();
@@ -63,7 +65,45 @@ void JrLab::JrLabCosmos::parse_cmdline_options(int argc, char* argv[]) {
     for (int idx = 1; idx < argc; idx ++) {
         switch (opt) {
         case CmdlineOps::GameOfLifeDemo: {
-            this->life_source = argv[idx];
+            this->life.demo = argv[idx];
+            opt = CmdlineOps::_;
+        }; break;
+        case CmdlineOps::GameOfLifeEngine: {
+            this->life.engine = argv[idx];
+            opt = CmdlineOps::_;
+        }; break;
+        case CmdlineOps::GameOfLifeRule: {
+            this->life.rule = argv[idx];
+            opt = CmdlineOps::_;
+        }; break;
+        case CmdlineOps::GameOfLifeJump: {
+            this->life.jump = std::atoi(argv[idx]);
+            opt = CmdlineOps::_;
+        }; break;
+        case CmdlineOps::GameOfLifeThreads: {
+            this->life.threads = std::atoi(argv[idx]);
+            opt = CmdlineOps::_;
+        }; break;
+        case CmdlineOps::GameOfLifeSize: {
+            // RxC, 比如 16384x16384
+            if (sscanf(argv[idx], "%dx%d", &this->life.rows, &this->life.cols) != 2) {
+                this->life.rows = 0;
+                this->life.cols = 0;
+            }
+
+            opt = CmdlineOps::_;
+        }; break;
+        case CmdlineOps::GameOfLifeLeap: {
+            this->life.leap = std::atoll(argv[idx]);
+            opt = CmdlineOps::_;
+        }; break;
+        case CmdlineOps::GameOfLifeTopology: {
+            this->life.topology = argv[idx];
+            opt = CmdlineOps::_;
+        }; break;
+        case CmdlineOps::RandomSeed: {
+            // 所有世界的随机数流都由它派生, 同一个种子可以重放同样的模拟
+            set_random_master_seed(std::strtoull(argv[idx], nullptr, 0));
             opt = CmdlineOps::_;
         }; break;
         case CmdlineOps::StreamFile: {
@@ -77,6 +117,22 @@ void JrLab::JrLabCosmos::parse_cmdline_options(int argc, char* argv[]) {
         default: {
             if (strncmp("--life", argv[idx], 7) == 0) {
                 opt = CmdlineOps::GameOfLifeDemo;
+            } else if (strncmp("--life-engine", argv[idx], 14) == 0) {
+                opt = CmdlineOps::GameOfLifeEngine;
+            } else if (strncmp("--life-rule", argv[idx], 12) == 0) {
+                opt = CmdlineOps::GameOfLifeRule;
+            } else if (strncmp("--life-jump", argv[idx], 12) == 0) {
+                opt = CmdlineOps::GameOfLifeJump;
+            } else if (strncmp("--life-threads", argv[idx], 15) == 0) {
+                opt = CmdlineOps::GameOfLifeThreads;
+            } else if (strncmp("--life-size", argv[idx], 12) == 0) {
+                opt = CmdlineOps::GameOfLifeSize;
+            } else if (strncmp("--life-leap", argv[idx], 12) == 0) {
+                opt = CmdlineOps::GameOfLifeLeap;
+            } else if (strncmp("--life-topology", argv[idx], 16) == 0) {
+                opt = CmdlineOps::GameOfLifeTopology;
+            } else if (strncmp("--seed", argv[idx], 7) == 0) {
+                opt = CmdlineOps::RandomSeed;
             } else if (strncmp("--pipe", argv[idx], 7) == 0) {
                 opt = CmdlineOps::StreamFile;
             } else if (strncmp("--carry", argv[idx], 8) == 0) {
@@ -2,9 +2,11 @@
 
 #include "splash.hpp"
 
+#include "JrLab/game_of_life.hpp"
+
 /*************************************************************************************************/
 namespace JrLab {
-    enum class CmdlineOps { GameOfLifeDemo, StreamFile, CarryNumber, _ };
+    enum class CmdlineOps { GameOfLifeDemo, GameOfLifeEngine, GameOfLifeRule, GameOfLifeJump, GameOfLifeThreads, GameOfLifeSize, GameOfLifeLeap, GameOfLifeTopology, RandomSeed, StreamFile, CarryNumber, _ };
 
     /* 定义本地宇宙类，并命名为 JrLabCosmos，继承自 TheCosmos 类 */
     class JrLabCosmos : public TheSplashCosmos {
@@ -20,7 +22,7 @@ namespace JrLab {
         void parse_cmdline_options(int argc, char* argv[]) override;
 
     private:
-        std::string life_source;
+        JrLab::GameOfLifeOptions life;
         std::string stream_source;
         size_t number = 0;
     };
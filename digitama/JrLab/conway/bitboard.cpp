@@ -0,0 +1,337 @@
+#include "bitboard.hpp"
+
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+using namespace JrLab;
+
+/*************************************************************************************************/
+static inline void half_add(uint64_t a, uint64_t b, uint64_t& sum, uint64_t& carry) {
+    sum = a ^ b;
+    carry = a & b;
+}
+
+static inline void full_add(uint64_t a, uint64_t b, uint64_t c, uint64_t& sum, uint64_t& carry) {
+    uint64_t t = a ^ b;
+
+    sum = t ^ c;
+    carry = (a & b) | (t & c);
+}
+
+// 第 c 位换成左边(第 c - 1 列)的细胞, west_in 是第 0 列左边移进来的那一位
+static inline uint64_t west_of(const uint64_t* row, int i, uint64_t west_in) {
+    return (row[i] << 1) | ((i > 0) ? (row[i - 1] >> 63) : west_in);
+}
+
+// 第 c 位换成右边(第 c + 1 列)的细胞, east_in 已经放在最后一列的位置上
+static inline uint64_t east_of(const uint64_t* row, int i, int wpr, uint64_t east_in) {
+    return (row[i] >> 1) | ((i + 1 < wpr) ? (row[i + 1] << 63) : east_in);
+}
+
+static inline int lowest_bit_index(uint64_t word) {
+#ifdef _MSC_VER
+    unsigned long idx;
+
+    _BitScanForward64(&idx, word);
+    return int(idx);
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+static inline int count_bits(uint64_t word) {
+#ifdef _MSC_VER
+    return int(__popcnt64(word));
+#else
+    return __builtin_popcountll(word);
+#endif
+}
+
+// 邻居数恰好为 n 的细胞, ones/twos/fours/eights 是邻居数的各个二进制位
+static inline uint64_t neighbors_equal(int n, uint64_t ones, uint64_t twos, uint64_t fours, uint64_t eights) {
+    uint64_t mask = eights;
+
+    if (n < 8) {
+        mask = ~eights
+            & ((n & 4) ? fours : ~fours)
+            & ((n & 2) ? twos : ~twos)
+            & ((n & 1) ? ones : ~ones);
+    }
+
+    return mask;
+}
+
+// 按 B/S 掩码合成下一代, 掩码是编译期常量时编译器会把循环和分支全部折叠掉
+static inline uint64_t next_generation(uint16_t birth, uint16_t survival,
+        uint64_t ones, uint64_t twos, uint64_t fours, uint64_t eights, uint64_t self) {
+    uint64_t next = 0ULL;
+
+    for (int n = 0; n <= 8; n ++) {
+        bool born = ((birth >> n) & 1U);
+        bool stay = ((survival >> n) & 1U);
+
+        if (born || stay) {
+            uint64_t hit = neighbors_equal(n, ones, twos, fours, eights);
+
+            if (born && stay) {
+                next |= hit;
+            } else if (born) {
+                next |= hit & ~self;
+            } else {
+                next |= hit & self;
+            }
+        }
+    }
+
+    return next;
+}
+
+template<uint16_t Birth, uint16_t Survival>
+struct StaticLifeRule {
+    inline uint64_t operator()(uint64_t ones, uint64_t twos, uint64_t fours, uint64_t eights, uint64_t self) const {
+        return next_generation(Birth, Survival, ones, twos, fours, eights, self);
+    }
+};
+
+// B3/S23: 邻居数为 3, 或者邻居数为 2 且自己活着
+template<>
+struct StaticLifeRule<conway_rule.birth, conway_rule.survival> {
+    inline uint64_t operator()(uint64_t ones, uint64_t twos, uint64_t fours, uint64_t eights, uint64_t self) const {
+        return twos & ~(fours | eights) & (ones | self);
+    }
+};
+
+struct DynamicLifeRule {
+    DynamicLifeRule(const LifeRule& rule) : birth(rule.birth), survival(rule.survival) {}
+
+    inline uint64_t operator()(uint64_t ones, uint64_t twos, uint64_t fours, uint64_t eights, uint64_t self) const {
+        return next_generation(this->birth, this->survival, ones, twos, fours, eights, self);
+    }
+
+    uint16_t birth;
+    uint16_t survival;
+};
+
+// 左右相接时, 每行的第 0 列和最后一列互为邻居; wrap_mask 为 0 时边界之外都是死细胞
+struct RowWrap {
+    RowWrap(const uint64_t* row, int wpr, int tail_bit, uint64_t wrap_mask)
+        : west_in(((row[wpr - 1] >> tail_bit) & 1ULL) & wrap_mask)
+        , east_in(((row[0] & 1ULL) << tail_bit) & wrap_mask) {}
+
+    uint64_t west_in;
+    uint64_t east_in;
+};
+
+template<typename Rule>
+static uint64_t evolve_band(const Rule& rule, const uint64_t* cells, uint64_t* shadow, const uint64_t* top, const uint64_t* bottom,
+        int row, int wpr, uint64_t tail_mask, int tail_bit, uint64_t wrap_mask, int r0, int rn) {
+    uint64_t changed = 0ULL;
+
+    for (int r = r0; r < rn; r ++) {
+        const uint64_t* up = (r > 0) ? cells + (r - 1) * wpr : top;
+        const uint64_t* mid = cells + r * wpr;
+        const uint64_t* down = (r + 1 < row) ? cells + (r + 1) * wpr : bottom;
+        uint64_t* next = shadow + r * wpr;
+        RowWrap uw(up, wpr, tail_bit, wrap_mask);
+        RowWrap mw(mid, wpr, tail_bit, wrap_mask);
+        RowWrap dw(down, wpr, tail_bit, wrap_mask);
+
+        for (int i = 0; i < wpr; i ++) {
+            uint64_t s_up, c_up, s_down, c_down, s_mid, c_mid;
+            uint64_t ones, c_ones, s_twos, c_twos, twos, c_fours;
+            uint64_t self = mid[i];
+
+            // 逐行把邻居数加成 "1 位" 和 "2 位"
+            full_add(west_of(up, i, uw.west_in), up[i], east_of(up, i, wpr, uw.east_in), s_up, c_up);
+            full_add(west_of(down, i, dw.west_in), down[i], east_of(down, i, wpr, dw.east_in), s_down, c_down);
+            half_add(west_of(mid, i, mw.west_in), east_of(mid, i, wpr, mw.east_in), s_mid, c_mid);
+
+            // 合并成邻居数的二进制位: ones 是 1 位, twos 是 2 位, 两个 "4 位" 的进位合起来是 4 位和 8 位
+            full_add(s_up, s_down, s_mid, ones, c_ones);
+            full_add(c_up, c_down, c_mid, s_twos, c_twos);
+            half_add(s_twos, c_ones, twos, c_fours);
+
+            next[i] = rule(ones, twos, c_twos ^ c_fours, c_twos & c_fours, self);
+
+            if (i == wpr - 1) {
+                next[i] &= tail_mask;
+            }
+
+            changed |= next[i] ^ self;
+        }
+    }
+
+    return changed;
+}
+
+/*************************************************************************************************/
+void JrLab::LifeBitBoard::resize(int row, int col) {
+    int tail = col % 64;
+
+    this->row = row;
+    this->col = col;
+    this->wpr = (col + 63) / 64;
+    this->tail_mask = (tail == 0) ? ~0ULL : ((1ULL << tail) - 1ULL);
+
+    this->cells.assign(size_t(row) * size_t(this->wpr), 0ULL);
+    this->shadow.assign(this->cells.size(), 0ULL);
+    this->top_halo.assign(size_t(this->wpr), 0ULL);
+    this->bottom_halo.assign(size_t(this->wpr), 0ULL);
+}
+
+void JrLab::LifeBitBoard::clear() {
+    std::fill(this->cells.begin(), this->cells.end(), 0ULL);
+    std::fill(this->shadow.begin(), this->shadow.end(), 0ULL);
+}
+
+int JrLab::LifeBitBoard::get(int r, int c) const {
+    return int((this->cells[r * this->wpr + (c >> 6)] >> (c & 63)) & 1ULL);
+}
+
+void JrLab::LifeBitBoard::set(int r, int c, int state) {
+    uint64_t& word = this->cells[r * this->wpr + (c >> 6)];
+    uint64_t bit = 1ULL << (c & 63);
+
+    if (state > 0) {
+        word |= bit;
+    } else {
+        word &= ~bit;
+    }
+}
+
+uint64_t JrLab::LifeBitBoard::population() const {
+    uint64_t population = 0U;
+
+    for (auto word : this->cells) {
+        population += uint64_t(count_bits(word));
+    }
+
+    return population;
+}
+
+size_t JrLab::LifeBitBoard::memory_footprint() const {
+    return (this->cells.capacity() + this->shadow.capacity()
+        + this->top_halo.capacity() + this->bottom_halo.capacity()) * sizeof(uint64_t);
+}
+
+/*************************************************************************************************/
+void JrLab::LifeBitBoard::pack(int** world, int row, int col) {
+    if ((this->row != row) || (this->col != col)) {
+        this->resize(row, col);
+    }
+
+    for (int r = 0; r < row; r ++) {
+        uint64_t* words = this->cells.data() + r * this->wpr;
+
+        for (int i = 0; i < this->wpr; i ++) {
+            int c0 = i * 64;
+            int cn = (c0 + 64 < col) ? c0 + 64 : col;
+            uint64_t word = 0ULL;
+
+            for (int c = c0; c < cn; c ++) {
+                if (world[r][c] > 0) {
+                    word |= 1ULL << (c - c0);
+                }
+            }
+
+            words[i] = word;
+        }
+    }
+}
+
+void JrLab::LifeBitBoard::unpack_changes(int** world, int r0, int rn, uint8_t* dirty_rows) {
+    for (int r = r0; r < rn; r ++) {
+        const uint64_t* words = this->cells.data() + r * this->wpr;
+        const uint64_t* prevs = this->shadow.data() + r * this->wpr;
+
+        for (int i = 0; i < this->wpr; i ++) {
+            uint64_t diff = words[i] ^ prevs[i];
+
+            if ((diff != 0ULL) && (dirty_rows != nullptr)) {
+                dirty_rows[r] = 1;
+            }
+
+            // 只展开发生了变化的字
+            while (diff != 0ULL) {
+                int bit = lowest_bit_index(diff);
+
+                world[r][i * 64 + bit] = int((words[i] >> bit) & 1ULL);
+                diff &= diff - 1ULL;
+            }
+        }
+    }
+}
+
+/*************************************************************************************************/
+void JrLab::LifeBitBoard::refresh_halo() {
+    if ((this->row == 0) || (this->topology == LifeTopology::Dead)) {
+        std::fill(this->top_halo.begin(), this->top_halo.end(), 0ULL);
+        std::fill(this->bottom_halo.begin(), this->bottom_halo.end(), 0ULL);
+    } else {
+        const uint64_t* first = this->cells.data();
+        const uint64_t* last = this->cells.data() + (this->row - 1) * this->wpr;
+
+        if (this->topology == LifeTopology::Torus) {
+            std::copy(last, last + this->wpr, this->top_halo.begin());
+            std::copy(first, first + this->wpr, this->bottom_halo.begin());
+        } else {
+            // 克莱因瓶: 穿过上下边界时左右翻转, 第 c 列接到第 col - 1 - c 列
+            std::fill(this->top_halo.begin(), this->top_halo.end(), 0ULL);
+            std::fill(this->bottom_halo.begin(), this->bottom_halo.end(), 0ULL);
+
+            for (int c = 0; c < this->col; c ++) {
+                int m = this->col - 1 - c;
+
+                this->top_halo[c >> 6] |= ((last[m >> 6] >> (m & 63)) & 1ULL) << (c & 63);
+                this->bottom_halo[c >> 6] |= ((first[m >> 6] >> (m & 63)) & 1ULL) << (c & 63);
+            }
+        }
+    }
+}
+
+bool JrLab::LifeBitBoard::evolve() {
+    bool changed = false;
+
+    this->refresh_halo();
+    changed = this->evolve_rows(0, this->row);
+
+    this->swap_generation();
+
+    return changed;
+}
+
+void JrLab::LifeBitBoard::swap_generation() {
+    this->cells.swap(this->shadow);
+}
+
+bool JrLab::LifeBitBoard::evolve_rows(int r0, int rn) {
+    const uint64_t* top = this->top_halo.data();
+    const uint64_t* bottom = this->bottom_halo.data();
+    const uint64_t* cells = this->cells.data();
+    uint64_t* shadow = this->shadow.data();
+    uint64_t wrap_mask = (this->topology == LifeTopology::Dead) ? 0ULL : ~0ULL;
+    int tail_bit = (this->col - 1) & 63;
+    uint64_t changed = 0ULL;
+
+    // 每一带只分派一次, 内层循环里没有虚调用和分支
+    if (this->rule == conway_rule) {
+        changed = evolve_band(StaticLifeRule<conway_rule.birth, conway_rule.survival>(),
+            cells, shadow, top, bottom, this->row, this->wpr, this->tail_mask, tail_bit, wrap_mask, r0, rn);
+    } else if (this->rule == highlife_rule) {
+        changed = evolve_band(StaticLifeRule<highlife_rule.birth, highlife_rule.survival>(),
+            cells, shadow, top, bottom, this->row, this->wpr, this->tail_mask, tail_bit, wrap_mask, r0, rn);
+    } else if (this->rule == seeds_rule) {
+        changed = evolve_band(StaticLifeRule<seeds_rule.birth, seeds_rule.survival>(),
+            cells, shadow, top, bottom, this->row, this->wpr, this->tail_mask, tail_bit, wrap_mask, r0, rn);
+    } else if (this->rule == day_and_night_rule) {
+        changed = evolve_band(StaticLifeRule<day_and_night_rule.birth, day_and_night_rule.survival>(),
+            cells, shadow, top, bottom, this->row, this->wpr, this->tail_mask, tail_bit, wrap_mask, r0, rn);
+    } else {
+        changed = evolve_band(DynamicLifeRule(this->rule), cells, shadow, top, bottom, this->row, this->wpr, this->tail_mask, tail_bit, wrap_mask, r0, rn);
+    }
+
+    return (changed != 0ULL);
+}
@@ -0,0 +1,69 @@
+#pragma once // 确保只被 include 一次
+
+#include "rule.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace JrLab {
+    /**
+     * 位压缩的生命棋盘
+     * 每个 uint64_t 存储同一行中连续的 64 个细胞, 第 c 列位于第 (c / 64) 个字的第 (c % 64) 位
+     * 演化时用位切片加法器一次算出整个字(64 个细胞)的邻居数和下一代状态;
+     * 常用规则的下一代公式在编译期展开, 其他规则按运行时的掩码逐个邻居数合成;
+     * 上下边界之外各有一行光环, 每代演化之前按拓扑刷新一次, 左右相接时每行首尾各补一位
+     */
+    class LifeBitBoard {
+    public:
+        LifeBitBoard(int row = 0, int col = 0) { this->resize(row, col); }
+
+    public:
+        void resize(int row, int col);
+        void clear();
+
+    public:
+        void set_rule(const JrLab::LifeRule& rule) { this->rule = rule; }
+        const JrLab::LifeRule& get_rule() const { return this->rule; }
+        void set_topology(JrLab::LifeTopology topology) { this->topology = topology; }
+        JrLab::LifeTopology get_topology() const { return this->topology; }
+
+    public:
+        int get(int r, int c) const;
+        void set(int r, int c, int state);
+
+    public:
+        void pack(int** world, int row, int col);
+        void unpack_changes(int** world, uint8_t* dirty_rows = nullptr) { this->unpack_changes(world, 0, this->row, dirty_rows); }
+        void unpack_changes(int** world, int r0, int rn, uint8_t* dirty_rows = nullptr);
+
+    public:
+        void refresh_halo();    // 分带演化之前调用一次
+        bool evolve();  // 演化一代, 返回是否有细胞发生了变化
+        bool evolve_rows(int r0, int rn);   // 只把 [r0, rn) 行的下一代写入影子棋盘, 各行带之间互不干扰
+        void swap_generation();
+
+    public:
+        int rows() const { return this->row; }
+        int cols() const { return this->col; }
+        int words_per_row() const { return this->wpr; }
+        const uint64_t* row_words(int r) const { return this->cells.data() + r * this->wpr; }
+        uint64_t population() const;
+        size_t memory_footprint() const;
+
+    private:
+        JrLab::LifeRule rule = JrLab::conway_rule;
+        JrLab::LifeTopology topology = JrLab::LifeTopology::Dead;
+
+    private:
+        int row = 0;
+        int col = 0;
+        int wpr = 0;            // 每行的字数
+        uint64_t tail_mask = 0; // 每行最后一个字中有效位的掩码
+
+    private:
+        std::vector<uint64_t> cells;
+        std::vector<uint64_t> shadow;   // 演化后存放上一代, 用于找出变化的字
+        std::vector<uint64_t> top_halo;     // 第 0 行上面的光环
+        std::vector<uint64_t> bottom_halo;  // 最后一行下面的光环
+    };
+}
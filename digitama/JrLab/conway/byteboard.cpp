@@ -0,0 +1,300 @@
+#include "byteboard.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define JRLAB_BYTEBOARD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define JRLAB_BYTEBOARD_SSE2
+#endif
+
+using namespace JrLab;
+
+/*************************************************************************************************/
+// 邻居数到诞生/存活的查找表, 每项是 0xFF 或 0
+struct GenerationsTable {
+    uint8_t birth[16];
+    uint8_t survival[16];
+    uint8_t states;
+};
+
+static inline GenerationsTable make_generations_table(const LifeRule& rule) {
+    GenerationsTable table;
+
+    for (int n = 0; n < 16; n ++) {
+        table.birth[n] = (((rule.birth >> n) & 1U) != 0U) ? 0xFFU : 0x00U;
+        table.survival[n] = (((rule.survival >> n) & 1U) != 0U) ? 0xFFU : 0x00U;
+    }
+
+    table.states = rule.states;
+
+    return table;
+}
+
+#if defined(JRLAB_BYTEBOARD_AVX2)
+static const int vector_width = 32;
+
+static inline __m256i alive_at(const uint8_t* cells, __m256i one) {
+    return _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(cells)), one);
+}
+
+// 一次演化一行里的 [0, cn) 列, cn 补齐到 32 的倍数, 多算的部分落在补齐的列里
+static void evolve_row(const GenerationsTable& table, const uint8_t* up, const uint8_t* mid, const uint8_t* down,
+        uint8_t* next, int cn) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i states = _mm256_set1_epi8(char(table.states));
+    const __m256i birth = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table.birth)));
+    const __m256i survival = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table.survival)));
+
+    for (int c = 0; c < cn; c += vector_width) {
+        __m256i self = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mid + c));
+        __m256i n = zero;
+        __m256i hit, older;
+
+        // 比较结果是 -1, 减去它就是加一
+        n = _mm256_sub_epi8(n, alive_at(up + c - 1, one));
+        n = _mm256_sub_epi8(n, alive_at(up + c, one));
+        n = _mm256_sub_epi8(n, alive_at(up + c + 1, one));
+        n = _mm256_sub_epi8(n, alive_at(mid + c - 1, one));
+        n = _mm256_sub_epi8(n, alive_at(mid + c + 1, one));
+        n = _mm256_sub_epi8(n, alive_at(down + c - 1, one));
+        n = _mm256_sub_epi8(n, alive_at(down + c, one));
+        n = _mm256_sub_epi8(n, alive_at(down + c + 1, one));
+
+        // 邻居数只有 0 到 8, 直接用字节混洗在 16 项的表里查
+        hit = _mm256_or_si256(
+            _mm256_and_si256(_mm256_cmpeq_epi8(self, zero), _mm256_shuffle_epi8(birth, n)),
+            _mm256_and_si256(_mm256_cmpeq_epi8(self, one), _mm256_shuffle_epi8(survival, n)));
+
+        older = _mm256_add_epi8(self, one);
+        older = _mm256_andnot_si256(_mm256_cmpeq_epi8(older, states), older);
+        older = _mm256_andnot_si256(_mm256_cmpeq_epi8(self, zero), older);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(next + c),
+            _mm256_or_si256(_mm256_and_si256(hit, one), _mm256_andnot_si256(hit, older)));
+    }
+}
+#elif defined(JRLAB_BYTEBOARD_SSE2)
+static const int vector_width = 16;
+
+static inline __m128i alive_at(const uint8_t* cells, __m128i one) {
+    return _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cells)), one);
+}
+
+// SSE2 没有字节混洗, 邻居数逐个和规则里出现的数比较
+static inline __m128i lookup(const uint8_t* entries, __m128i n) {
+    __m128i hit = _mm_setzero_si128();
+
+    for (int k = 0; k <= 8; k ++) {
+        if (entries[k] != 0U) {
+            hit = _mm_or_si128(hit, _mm_cmpeq_epi8(n, _mm_set1_epi8(char(k))));
+        }
+    }
+
+    return hit;
+}
+
+static void evolve_row(const GenerationsTable& table, const uint8_t* up, const uint8_t* mid, const uint8_t* down,
+        uint8_t* next, int cn) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi8(1);
+    const __m128i states = _mm_set1_epi8(char(table.states));
+
+    for (int c = 0; c < cn; c += vector_width) {
+        __m128i self = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mid + c));
+        __m128i n = zero;
+        __m128i hit, older;
+
+        n = _mm_sub_epi8(n, alive_at(up + c - 1, one));
+        n = _mm_sub_epi8(n, alive_at(up + c, one));
+        n = _mm_sub_epi8(n, alive_at(up + c + 1, one));
+        n = _mm_sub_epi8(n, alive_at(mid + c - 1, one));
+        n = _mm_sub_epi8(n, alive_at(mid + c + 1, one));
+        n = _mm_sub_epi8(n, alive_at(down + c - 1, one));
+        n = _mm_sub_epi8(n, alive_at(down + c, one));
+        n = _mm_sub_epi8(n, alive_at(down + c + 1, one));
+
+        hit = _mm_or_si128(
+            _mm_and_si128(_mm_cmpeq_epi8(self, zero), lookup(table.birth, n)),
+            _mm_and_si128(_mm_cmpeq_epi8(self, one), lookup(table.survival, n)));
+
+        older = _mm_add_epi8(self, one);
+        older = _mm_andnot_si128(_mm_cmpeq_epi8(older, states), older);
+        older = _mm_andnot_si128(_mm_cmpeq_epi8(self, zero), older);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(next + c),
+            _mm_or_si128(_mm_and_si128(hit, one), _mm_andnot_si128(hit, older)));
+    }
+}
+#else
+static const int vector_width = 1;
+
+/**
+ * 下一代 = (诞生或存活) ? 1 : ((自己非 0) ? 自己 + 1 : 0), 其中自己 + 1 到 states 时回到 0;
+ * 不能存活的活细胞正好变成 2(两态规则里 2 就是 states, 于是回到 0), 向量版本是同一个公式
+ */
+static inline uint8_t next_generations_state(const GenerationsTable& table, uint8_t self, int n) {
+    uint8_t hit = (self == 0) ? table.birth[n] : ((self == 1) ? table.survival[n] : 0U);
+    uint8_t older = uint8_t(self + 1);
+
+    if (older == table.states) {
+        older = 0U;
+    }
+
+    return (hit != 0U) ? 1U : ((self != 0U) ? older : 0U);
+}
+
+static void evolve_row(const GenerationsTable& table, const uint8_t* up, const uint8_t* mid, const uint8_t* down,
+        uint8_t* next, int cn) {
+    for (int c = 0; c < cn; c ++) {
+        int n = (up[c - 1] == 1) + (up[c] == 1) + (up[c + 1] == 1)
+              + (mid[c - 1] == 1) + (mid[c + 1] == 1)
+              + (down[c - 1] == 1) + (down[c] == 1) + (down[c + 1] == 1);
+
+        next[c] = next_generations_state(table, mid[c], n);
+    }
+}
+#endif
+
+/*************************************************************************************************/
+void JrLab::LifeByteBoard::resize(int row, int col) {
+    this->row = row;
+    this->col = col;
+
+    // 最后一个向量读到的右邻居也要落在本行之内
+    this->stride = (col + lanes - 1) / lanes * lanes + lanes;
+
+    this->cells.assign(size_t(row + 2) * size_t(this->stride), 0U);
+    this->shadow.assign(this->cells.size(), 0U);
+}
+
+void JrLab::LifeByteBoard::clear() {
+    std::fill(this->cells.begin(), this->cells.end(), 0U);
+    std::fill(this->shadow.begin(), this->shadow.end(), 0U);
+}
+
+uint64_t JrLab::LifeByteBoard::population() const {
+    uint64_t population = 0U;
+
+    for (int r = 0; r < this->row; r ++) {
+        const uint8_t* cells = this->cells.data() + this->offset(r, 0);
+
+        for (int c = 0; c < this->col; c ++) {
+            population += (cells[c] != 0U) ? 1U : 0U;
+        }
+    }
+
+    return population;
+}
+
+size_t JrLab::LifeByteBoard::memory_footprint() const {
+    return this->cells.capacity() + this->shadow.capacity();
+}
+
+void JrLab::LifeByteBoard::pack(int** world, int row, int col) {
+    if ((this->row != row) || (this->col != col)) {
+        this->resize(row, col);
+    }
+
+    // 超出状态数的值(比如从两态的文件里读到的)一律当作活细胞
+    for (int r = 0; r < row; r ++) {
+        uint8_t* cells = this->cells.data() + this->offset(r, 0);
+
+        for (int c = 0; c < col; c ++) {
+            int state = world[r][c];
+
+            cells[c] = uint8_t(((state >= 0) && (state < this->rule.states)) ? state : 1);
+        }
+    }
+}
+
+void JrLab::LifeByteBoard::unpack_changes(int** world, int r0, int rn, uint8_t* dirty_rows) {
+    for (int r = r0; r < rn; r ++) {
+        const uint8_t* cells = this->cells.data() + this->offset(r, 0);
+        const uint8_t* prevs = this->shadow.data() + this->offset(r, 0);
+
+        // 整行没变就跳过, memcmp 本身就是向量化的
+        if (memcmp(cells, prevs, size_t(this->col)) != 0) {
+            for (int c = 0; c < this->col; c ++) {
+                world[r][c] = cells[c];
+            }
+
+            if (dirty_rows != nullptr) {
+                dirty_rows[r] = 1;
+            }
+        }
+    }
+}
+
+void JrLab::LifeByteBoard::refresh_halo() {
+    uint8_t* top = this->cells.data() + this->offset(-1, -1);
+    uint8_t* bottom = this->cells.data() + this->offset(this->row, -1);
+
+    // 先补左右两列, 上下两行连同四个角一起从补好的行里复制
+    for (int r = 0; r < this->row; r ++) {
+        uint8_t* cells = this->cells.data() + this->offset(r, 0);
+
+        if (this->topology == LifeTopology::Dead) {
+            cells[-1] = 0U;
+            cells[this->col] = 0U;
+        } else {
+            cells[-1] = cells[this->col - 1];
+            cells[this->col] = cells[0];
+        }
+    }
+
+    if ((this->row == 0) || (this->topology == LifeTopology::Dead)) {
+        std::fill(top, top + this->col + 2, 0U);
+        std::fill(bottom, bottom + this->col + 2, 0U);
+    } else {
+        const uint8_t* first = this->cells.data() + this->offset(0, -1);
+        const uint8_t* last = this->cells.data() + this->offset(this->row - 1, -1);
+
+        if (this->topology == LifeTopology::Torus) {
+            std::copy(last, last + this->col + 2, top);
+            std::copy(first, first + this->col + 2, bottom);
+        } else {
+            // 克莱因瓶: 穿过上下边界时左右翻转, 连光环列在内整行倒过来
+            std::reverse_copy(last, last + this->col + 2, top);
+            std::reverse_copy(first, first + this->col + 2, bottom);
+        }
+    }
+}
+
+bool JrLab::LifeByteBoard::evolve() {
+    bool changed = false;
+
+    this->refresh_halo();
+    changed = this->evolve_rows(0, this->row);
+
+    this->swap_generation();
+
+    return changed;
+}
+
+void JrLab::LifeByteBoard::swap_generation() {
+    this->cells.swap(this->shadow);
+}
+
+bool JrLab::LifeByteBoard::evolve_rows(int r0, int rn) {
+    GenerationsTable table = make_generations_table(this->rule);
+    int cn = (this->col + vector_width - 1) / vector_width * vector_width;
+    bool changed = false;
+
+    for (int r = r0; r < rn; r ++) {
+        const uint8_t* mid = this->cells.data() + this->offset(r, 0);
+        uint8_t* next = this->shadow.data() + this->offset(r, 0);
+
+        evolve_row(table, mid - this->stride, mid, mid + this->stride, next, cn);
+
+        if ((!changed) && (memcmp(mid, next, size_t(this->col)) != 0)) {
+            changed = true;
+        }
+    }
+
+    return changed;
+}
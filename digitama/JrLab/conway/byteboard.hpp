@@ -0,0 +1,69 @@
+#pragma once // 确保只被 include 一次
+
+#include "rule.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace JrLab {
+    /**
+     * 一个字节一个细胞的多态生命棋盘, 用来演化 Generations 规则
+     * 每行前后各留一列光环, 行宽补齐到向量宽度的整数倍, 上下各有一行光环, 每代演化之前按拓扑刷新;
+     * 演化时一次处理一整个向量(AVX2 32 个, SSE2 16 个细胞): 把八个邻居"是否为活细胞"的比较结果直接累加成邻居数,
+     * 再用邻居数查出诞生/存活, 衰老中的细胞加一(到 states 回到 0), 整个过程没有分支;
+     * 编译器不支持 SSE2 时退回逐个字节的版本
+     */
+    class LifeByteBoard {
+    public:
+        LifeByteBoard(int row = 0, int col = 0) { this->resize(row, col); }
+
+    public:
+        void resize(int row, int col);
+        void clear();
+
+    public:
+        void set_rule(const JrLab::LifeRule& rule) { this->rule = rule; }
+        const JrLab::LifeRule& get_rule() const { return this->rule; }
+        void set_topology(JrLab::LifeTopology topology) { this->topology = topology; }
+        JrLab::LifeTopology get_topology() const { return this->topology; }
+
+    public:
+        int get(int r, int c) const { return this->cells[this->offset(r, c)]; }
+        void set(int r, int c, int state) { this->cells[this->offset(r, c)] = uint8_t(state); }
+
+    public:
+        void pack(int** world, int row, int col);
+        void unpack_changes(int** world, int r0, int rn, uint8_t* dirty_rows = nullptr);
+
+    public:
+        void refresh_halo();    // 分带演化之前调用一次
+        bool evolve();  // 演化一代, 返回是否有细胞发生了变化
+        bool evolve_rows(int r0, int rn);   // 只把 [r0, rn) 行的下一代写入影子棋盘, 各行带之间互不干扰
+        void swap_generation();
+
+    public:
+        int rows() const { return this->row; }
+        int cols() const { return this->col; }
+        uint64_t population() const;    // 所有非 0 状态的细胞, 包括衰老中的
+        size_t memory_footprint() const;
+
+    public:
+        static const int lanes = 32;    // 行宽按最宽的向量对齐
+
+    private:
+        size_t offset(int r, int c) const { return size_t(r + 1) * size_t(this->stride) + size_t(c + 1); }
+
+    private:
+        JrLab::LifeRule rule = JrLab::brians_brain_rule;
+        JrLab::LifeTopology topology = JrLab::LifeTopology::Dead;
+
+    private:
+        int row = 0;
+        int col = 0;
+        int stride = 0;     // 每行的字节数, 包括左右光环和补齐的部分
+
+    private:
+        std::vector<uint8_t> cells;
+        std::vector<uint8_t> shadow;    // 演化后存放上一代, 用于找出变化的细胞
+    };
+}
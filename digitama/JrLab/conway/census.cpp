@@ -0,0 +1,606 @@
+#include "census.hpp"
+#include "bitboard.hpp"
+
+#include "../parallel/workpool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+using namespace JrLab;
+
+/*************************************************************************************************/
+typedef std::vector<std::pair<int, int>> LifeCells;    // (行, 列)
+
+struct LifeObjectInfo {
+    std::string code;
+    bool moving = false;
+};
+
+struct NamedLifeObject {
+    const char* name;
+    const char* cells;  // 行之间用 $ 分隔, o 是活细胞
+};
+
+static const NamedLifeObject named_objects[] = {
+    { "block", "oo$oo" },
+    { "beehive", ".oo.$o..o$.oo." },
+    { "loaf", ".oo.$o..o$.o.o$..o." },
+    { "boat", "oo.$o.o$.o." },
+    { "ship", "oo.$o.o$.oo" },
+    { "tub", ".o.$o.o$.o." },
+    { "pond", ".oo.$o..o$o..o$.oo." },
+    { "long boat", "oo..$o.o.$.o.o$..o." },
+    { "barge", ".o..$o.o.$.o.o$..o." },
+    { "snake", "oo.o$o.oo" },
+    { "aircraft carrier", "oo..$o..o$..oo" },
+    { "eater 1", "oo..$o.o.$..o.$..oo" },
+    { "blinker", "ooo" },
+    { "toad", ".ooo$ooo." },
+    { "beacon", "oo..$oo..$..oo$..oo" },
+    { "pentadecathlon", "..o....o..$oo.oooo.oo$..o....o.." },
+    { "pulsar", "..ooo...ooo..$.............$o....o.o....o$o....o.o....o$o....o.o....o$..ooo...ooo..$"
+                ".............$..ooo...ooo..$o....o.o....o$o....o.o....o$o....o.o....o$.............$..ooo...ooo.." },
+    { "glider", ".o.$..o$ooo" },
+    { "lightweight spaceship", ".o..o$o....$o...o$oooo." },
+    { "middleweight spaceship", "...o..$.o...o$o.....$o....o$ooooo." },
+    { "heavyweight spaceship", "...oo..$.o....o$o......$o.....o$oooooo." }
+};
+
+static const char wechsler_digits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+static const int max_object_period = 64;
+static const int stability_check_interval = 32;
+static const int min_stability_window = 64;
+static const int escape_check_interval = 16;
+static const int escape_band = 16;          // 离场地边缘这么近的飞船就算飞走了
+static const int batches_per_worker = 8;
+
+static inline int lowest_bit_index(uint64_t word) {
+#ifdef _MSC_VER
+    unsigned long idx;
+
+    _BitScanForward64(&idx, word);
+    return int(idx);
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+/*************************************************************************************************/
+static LifeCells collect_cells(const LifeBitBoard& board) {
+    LifeCells cells;
+
+    for (int r = 0; r < board.rows(); r ++) {
+        const uint64_t* words = board.row_words(r);
+
+        for (int i = 0; i < board.words_per_row(); i ++) {
+            uint64_t word = words[i];
+
+            while (word != 0ULL) {
+                cells.push_back({ r, i * 64 + lowest_bit_index(word) });
+                word &= word - 1ULL;
+            }
+        }
+    }
+
+    return cells;
+}
+
+// 平移到左上角并排序, 形状相同的物体得到完全相同的序列
+static void normalize(LifeCells& cells, int* min_r = nullptr, int* min_c = nullptr) {
+    int r0 = 0;
+    int c0 = 0;
+
+    if (!cells.empty()) {
+        r0 = cells[0].first;
+        c0 = cells[0].second;
+
+        for (auto& cell : cells) {
+            r0 = std::min(r0, cell.first);
+            c0 = std::min(c0, cell.second);
+        }
+
+        for (auto& cell : cells) {
+            cell.first -= r0;
+            cell.second -= c0;
+        }
+
+        std::sort(cells.begin(), cells.end());
+    }
+
+    if (min_r != nullptr) {
+        (*min_r) = r0;
+    }
+
+    if (min_c != nullptr) {
+        (*min_c) = c0;
+    }
+}
+
+// 八种朝向: 第 2 位转置, 第 0 位上下翻转, 第 1 位左右翻转
+static LifeCells orient(const LifeCells& cells, int orientation) {
+    LifeCells oriented;
+
+    for (auto& cell : cells) {
+        int r = cell.first;
+        int c = cell.second;
+
+        if (orientation & 4) {
+            std::swap(r, c);
+        }
+
+        oriented.push_back({ (orientation & 1) ? -r : r, (orientation & 2) ? -c : c });
+    }
+
+    normalize(oriented);
+
+    return oriented;
+}
+
+/**
+ * 扩展 Wechsler 编码: 每 5 行切成一条, 每列的 5 个细胞组成一个 0-31 的数字;
+ * 条之间用 z 分隔, 连续的 0 压缩成 w(2 个), x(3 个), y?(4 个起)
+ */
+static std::string wechsler(const LifeCells& cells) {
+    std::string code;
+    int height = 0;
+    int width = 0;
+
+    for (auto& cell : cells) {
+        height = std::max(height, cell.first + 1);
+        width = std::max(width, cell.second + 1);
+    }
+
+    for (int strip = 0; strip * 5 < height; strip ++) {
+        std::vector<int> columns(size_t(width), 0);
+        int zeros = 0;
+
+        for (auto& cell : cells) {
+            if (cell.first / 5 == strip) {
+                columns[cell.second] |= 1 << (cell.first % 5);
+            }
+        }
+
+        if (strip > 0) {
+            code.push_back('z');
+        }
+
+        for (int c = 0; c < width; c ++) {
+            if (columns[c] == 0) {
+                zeros ++;
+            } else {
+                while (zeros > 0) {
+                    int run = std::min(zeros, 39);
+
+                    switch (run) {
+                    case 1: code.push_back('0'); break;
+                    case 2: code.push_back('w'); break;
+                    case 3: code.push_back('x'); break;
+                    default: code.push_back('y'); code.push_back(wechsler_digits[run - 4]);
+                    }
+
+                    zeros -= run;
+                }
+
+                code.push_back(wechsler_digits[columns[c]]);
+            }
+        }
+    }
+
+    return code;
+}
+
+static inline bool prefer_code(const std::string& a, const std::string& b) {
+    return (a.size() < b.size()) || ((a.size() == b.size()) && (a < b));
+}
+
+static std::string canonical_wechsler(const std::vector<LifeCells>& phases) {
+    std::string best;
+
+    for (auto& phase : phases) {
+        for (int orientation = 0; orientation < 8; orientation ++) {
+            std::string code = wechsler(orient(phase, orientation));
+
+            if (best.empty() || prefer_code(code, best)) {
+                best = code;
+            }
+        }
+    }
+
+    return best;
+}
+
+static LifeCells parse_cells(const char* pattern) {
+    LifeCells cells;
+    int r = 0;
+    int c = 0;
+
+    for (int idx = 0; pattern[idx] != '\0'; idx ++) {
+        switch (pattern[idx]) {
+        case '$': r ++; c = 0; break;
+        case 'o': cells.push_back({ r, c ++ }); break;
+        default: c ++;
+        }
+    }
+
+    normalize(cells);
+
+    return cells;
+}
+
+/*************************************************************************************************/
+// 把物体单独放到足够大的场地上演化, 找出周期和是否在移动, 再生成规范编码; cells 必须已经 normalize
+static LifeObjectInfo identify_object(const LifeCells& cells, const LifeRule& rule) {
+    std::vector<LifeCells> phases { cells };
+    int margin = max_object_period / 2 + 4;     // 飞船最快每两代移动一格
+    int height = 0;
+    int width = 0;
+    int period = 0;
+    LifeObjectInfo info;
+
+    for (auto& cell : cells) {
+        height = std::max(height, cell.first + 1);
+        width = std::max(width, cell.second + 1);
+    }
+
+    LifeBitBoard isolation(height + margin * 2, width + margin * 2);
+
+    isolation.set_rule(rule);
+
+    for (auto& cell : cells) {
+        isolation.set(cell.first + margin, cell.second + margin, 1);
+    }
+
+    for (int t = 1; t <= max_object_period; t ++) {
+        LifeCells current;
+        int r0, c0, rn = 0, cn = 0;
+
+        isolation.evolve();
+        current = collect_cells(isolation);
+        normalize(current, &r0, &c0);
+
+        for (auto& cell : current) {
+            rn = std::max(rn, cell.first + r0 + 1);
+            cn = std::max(cn, cell.second + c0 + 1);
+        }
+
+        // 死光了, 或者长到了场地边上, 都说明它自己不是一个稳定的物体
+        if (current.empty() || (r0 == 0) || (c0 == 0) || (rn >= isolation.rows()) || (cn >= isolation.cols())) {
+            break;
+        }
+
+        if (current == cells) {
+            period = t;
+            info.moving = (r0 != margin) || (c0 != margin);
+            break;
+        }
+
+        phases.push_back(current);
+    }
+
+    if (period == 0) {
+        info.code = "xx_" + canonical_wechsler({ cells });
+    } else if (info.moving) {
+        info.code = "xq" + std::to_string(period) + "_" + canonical_wechsler(phases);
+    } else if (period == 1) {
+        info.code = "xs" + std::to_string(cells.size()) + "_" + canonical_wechsler(phases);
+    } else {
+        info.code = "xp" + std::to_string(period) + "_" + canonical_wechsler(phases);
+    }
+
+    return info;
+}
+
+// 按切比雪夫距离 radius 把细胞分成若干个物体, radius 为 1 即八连通
+static std::vector<LifeCells> split_objects(const LifeCells& cells, int rows, int cols, int radius, std::vector<int>& labels) {
+    std::vector<LifeCells> objects;
+    std::vector<size_t> queue;
+
+    labels.assign(size_t(rows) * size_t(cols), -1);
+
+    for (size_t idx = 0; idx < cells.size(); idx ++) {
+        labels[size_t(cells[idx].first) * size_t(cols) + size_t(cells[idx].second)] = int(idx);
+    }
+
+    for (size_t idx = 0; idx < cells.size(); idx ++) {
+        int& seed = labels[size_t(cells[idx].first) * size_t(cols) + size_t(cells[idx].second)];
+
+        if (seed >= 0) {
+            LifeCells object;
+
+            seed = -2;
+            queue.assign(1, idx);
+
+            while (!queue.empty()) {
+                std::pair<int, int> cell = cells[queue.back()];
+
+                queue.pop_back();
+                object.push_back(cell);
+
+                for (int r = std::max(cell.first - radius, 0); r <= std::min(cell.first + radius, rows - 1); r ++) {
+                    for (int c = std::max(cell.second - radius, 0); c <= std::min(cell.second + radius, cols - 1); c ++) {
+                        int& label = labels[size_t(r) * size_t(cols) + size_t(c)];
+
+                        if (label >= 0) {
+                            queue.push_back(size_t(label));
+                            label = -2;
+                        }
+                    }
+                }
+            }
+
+            objects.push_back(object);
+        }
+    }
+
+    return objects;
+}
+
+/*************************************************************************************************/
+namespace {
+    class LifeSoupLab {
+    public:
+        LifeSoupLab(const LifeCensusOptions& options)
+            : options(options), board(options.arena_size, options.arena_size) {
+            this->board.set_rule(options.rule);
+            this->density256 = int(options.density * 256.0 + 0.5);
+        }
+
+    public:
+        void run(uint64_t index) {
+            LifeSoupRandom rng(this->options.seed, index);
+            int size = this->options.soup_size;
+            int offset = (this->options.arena_size - size) / 2;
+            bool stabilized = false;
+            long long g = 0;
+
+            this->board.clear();
+            this->populations.clear();
+            this->escaped.clear();
+
+            // 每行一次取 64 个随机位, 只用前 soup_size 位
+            for (int r = 0; r < size; r ++) {
+                uint64_t bits = rng.bits(this->density256);
+
+                for (int c = 0; c < size; c ++) {
+                    this->board.set(offset + r, offset + c, int((bits >> c) & 1ULL));
+                }
+            }
+
+            while ((!stabilized) && (g < this->options.max_generations)) {
+                this->board.evolve();
+                this->populations.push_back(this->board.population());
+                g ++;
+
+                if (g % escape_check_interval == 0) {
+                    this->catch_escapees();
+                }
+
+                if (g % stability_check_interval == 0) {
+                    stabilized = this->is_periodic();
+                }
+            }
+
+            this->generations += g;
+
+            if (stabilized) {
+                this->stabilized ++;
+
+                for (auto& code : this->escaped) {
+                    this->counts[code] ++;
+                }
+
+                this->census();
+            }
+        }
+
+    public:
+        std::map<std::string, long long> counts;
+        long long stabilized = 0;
+        long long generations = 0;
+
+    private:
+        const LifeObjectInfo& classify(const LifeCells& object) {
+            LifeCells shape = object;
+            std::string key;
+
+            normalize(shape);
+            key = wechsler(shape);
+
+            // 同一形状同一相位的物体只需辨认一次
+            auto it = this->known.find(key);
+
+            if (it == this->known.end()) {
+                it = this->known.insert({ key, identify_object(shape, this->options.rule) }).first;
+            }
+
+            return it->second;
+        }
+
+        void catch_escapees() {
+            LifeCells cells = collect_cells(this->board);
+            int far = this->options.arena_size - escape_band;
+            bool near_edge = false;
+
+            for (auto& cell : cells) {
+                if ((cell.first < escape_band) || (cell.second < escape_band) || (cell.first >= far) || (cell.second >= far)) {
+                    near_edge = true;
+                    break;
+                }
+            }
+
+            // 快要撞上场地边缘的飞船记下来之后直接抹掉, 免得它撞成一堆残骸
+            if (near_edge) {
+                for (auto& object : split_objects(cells, this->board.rows(), this->board.cols(), 1, this->labels)) {
+                    bool touching = false;
+
+                    for (auto& cell : object) {
+                        if ((cell.first < escape_band) || (cell.second < escape_band) || (cell.first >= far) || (cell.second >= far)) {
+                            touching = true;
+                            break;
+                        }
+                    }
+
+                    if (touching) {
+                        const LifeObjectInfo& info = this->classify(object);
+
+                        if (info.moving) {
+                            this->escaped.push_back(info.code);
+
+                            for (auto& cell : object) {
+                                this->board.set(cell.first, cell.second, 0);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // 飞行中的飞船会让棋盘永远不重复, 所以只看细胞数是否已经周期性地重复了足够长的时间
+        bool is_periodic() {
+            long long g = (long long)(this->populations.size());
+
+            for (int p = 1; p <= max_object_period; p ++) {
+                long long window = std::max(p * 4, min_stability_window);
+                bool periodic = (g >= window + p);
+
+                for (long long i = 0; periodic && (i < window); i ++) {
+                    periodic = (this->populations[size_t(g - 1 - i)] == this->populations[size_t(g - 1 - i - p)]);
+                }
+
+                if (periodic) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        void census() {
+            LifeCells cells = collect_cells(this->board);
+            LifeCells debris;
+
+            for (auto& object : split_objects(cells, this->board.rows(), this->board.cols(), 1, this->labels)) {
+                const LifeObjectInfo& info = this->classify(object);
+
+                if (info.code[1] == 'x') {
+                    debris.insert(debris.end(), object.begin(), object.end());
+                } else {
+                    this->counts[info.code] ++;
+                }
+            }
+
+            // 八连通的碎片单独演化不稳定, 可能本来就是同一个物体(比如脉冲星的四个角), 放宽距离再认一次
+            if (!debris.empty()) {
+                for (auto& object : split_objects(debris, this->board.rows(), this->board.cols(), 2, this->labels)) {
+                    this->counts[this->classify(object).code] ++;
+                }
+            }
+        }
+
+    private:
+        const LifeCensusOptions& options;
+        LifeBitBoard board;
+        std::vector<uint64_t> populations;
+        std::vector<std::string> escaped;
+        std::vector<int> labels;
+        std::unordered_map<std::string, LifeObjectInfo> known;
+        int density256;
+    };
+}
+
+/*************************************************************************************************/
+uint64_t JrLab::LifeSoupRandom::bits(int density256) {
+    uint64_t x = 0ULL;
+
+    if (density256 >= 256) {
+        x = ~0ULL;
+    } else if (density256 > 0) {
+        int k = lowest_bit_index(uint64_t(density256));
+
+        /**
+         * 把概率写成二进制小数 0.b1b2...b8, 从最低的非零位往高位走:
+         * 该位为 1 就和新的随机字取或(概率变成 1/2 + p/2), 为 0 就取与(概率变成 p/2)
+         */
+        for (int bit = k; bit < 8; bit ++) {
+            uint64_t r = this->next();
+
+            x = ((density256 >> bit) & 1) ? (x | r) : (x & r);
+        }
+    }
+
+    return x;
+}
+
+/*************************************************************************************************/
+LifeCensusReport JrLab::run_life_census(const LifeCensusOptions& options, long long soups) {
+    LifeCensusReport report;
+    std::map<std::string, long long> counts;
+    std::map<std::string, std::string> names;
+    std::mutex lock;
+    WorkPool workers(options.threads);
+    int batch_count = int(std::min(soups, (long long)(workers.size() * batches_per_worker)));
+    auto t0 = std::chrono::steady_clock::now();
+
+    // 每一批汤由一个实验室负责, 自己攒着计数和物体缓存, 做完再合并, 各个核之间几乎不用同步
+    if (batch_count > 0) {
+        workers.run(batch_count, [&](int batch) {
+            LifeSoupLab lab(options);
+            long long i0 = soups * batch / batch_count;
+            long long in = soups * (batch + 1) / batch_count;
+
+            for (long long i = i0; i < in; i ++) {
+                lab.run(uint64_t(i));
+            }
+
+            std::unique_lock<std::mutex> guard(lock);
+
+            for (auto& count : lab.counts) {
+                counts[count.first] += count.second;
+            }
+
+            report.stabilized += lab.stabilized;
+            report.generations += lab.generations;
+        });
+    }
+
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    report.soups = soups;
+
+    for (auto& named : named_objects) {
+        LifeObjectInfo info = identify_object(parse_cells(named.cells), options.rule);
+
+        // 在别的规则下不稳定的物体没有资格用这个名字
+        if (info.code[1] != 'x') {
+            names[info.code] = named.name;
+        }
+    }
+
+    for (auto& count : counts) {
+        report.table.push_back({ count.first, names[count.first], count.second });
+        report.objects += count.second;
+    }
+
+    std::sort(report.table.begin(), report.table.end(), [](const LifeCensusEntry& a, const LifeCensusEntry& b) {
+        return (a.count > b.count) || ((a.count == b.count) && (a.code < b.code));
+    });
+
+    return report;
+}
+
+void JrLab::write_life_census(std::ostream& out, const LifeCensusReport& report) {
+    out << "code,name,count,per_soup\n";
+
+    for (auto& entry : report.table) {
+        out << entry.code << ',' << entry.name << ',' << entry.count << ','
+            << ((report.soups > 0) ? double(entry.count) / double(report.soups) : 0.0) << '\n';
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once // 确保只被 include 一次
+
+#include "rule.hpp"
+
+#include "../random/stream.hpp"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace JrLab {
+    /**
+     * 随机汤专用的随机数发生器, 在随机数流的基础上按密度生成随机位
+     * 每一锅汤用 (种子, 汤的编号) 单独播种, 普查结果与线程数和调度顺序无关;
+     * bits 一次生成 64 个独立的随机位, 每一位为 1 的概率是 density256 / 256
+     */
+    class LifeSoupRandom : public JrLab::RandomStream {
+    public:
+        LifeSoupRandom(uint64_t seed, uint64_t stream = 0U) : RandomStream(seed, stream) {}
+
+    public:
+        uint64_t bits(int density256);
+    };
+
+    struct LifeCensusOptions {
+        JrLab::LifeRule rule = JrLab::conway_rule;
+        double density = 0.5;               // 汤里活细胞的比例, 精度为 1/256
+        int soup_size = 16;                 // 汤的边长, 不超过 64
+        int arena_size = 256;               // 演化场地的边长, 汤放在正中间
+        long long max_generations = 20000;  // 超过这么多代还没稳定的汤不计入统计
+        uint64_t seed = 0U;
+        int threads = 0;                    // 0 表示使用所有的 CPU 核
+    };
+
+    /**
+     * 物体的编码仿照 apgcode: 静物 xs<细胞数>_, 振荡子 xp<周期>_, 飞船 xq<周期>_, 后面是扩展 Wechsler 编码,
+     * 取所有相位和八种朝向里最短(等长时字典序最小)的那个; 单独演化找不到周期的残骸记作 xx_
+     */
+    struct LifeCensusEntry {
+        std::string code;
+        std::string name;   // 常见物体的名字, 不认识的留空
+        long long count = 0;
+    };
+
+    struct LifeCensusReport {
+        long long soups = 0;
+        long long stabilized = 0;
+        long long generations = 0;
+        long long objects = 0;
+        double seconds = 0.0;
+        std::vector<JrLab::LifeCensusEntry> table;  // 按数量从多到少排列
+    };
+
+    // 并行演化 soups 锅随机汤直到稳定, 统计其中(包括中途飞出场地)的所有物体
+    JrLab::LifeCensusReport run_life_census(const JrLab::LifeCensusOptions& options, long long soups);
+
+    // 把频数表写成 CSV: code,name,count,per_soup
+    void write_life_census(std::ostream& out, const JrLab::LifeCensusReport& report);
+}
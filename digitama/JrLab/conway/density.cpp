@@ -0,0 +1,140 @@
+#include "density.hpp"
+
+#include <algorithm>
+
+using namespace JrLab;
+
+/*************************************************************************************************/
+void JrLab::LifeDensityPyramid::resize(int row, int col) {
+    int size = 1 << base_shift;
+
+    this->row = row;
+    this->col = col;
+    this->rows.clear();
+    this->cols.clear();
+    this->densities.clear();
+    this->dirty.clear();
+
+    do {
+        int brows = (row + size - 1) / size;
+        int bcols = (col + size - 1) / size;
+
+        this->rows.push_back(brows);
+        this->cols.push_back(bcols);
+        this->densities.push_back(std::vector<uint8_t>(size_t(brows) * size_t(bcols), 0U));
+        this->dirty.push_back(std::vector<uint8_t>(size_t(brows), 1U));
+        size <<= 1;
+    } while ((this->rows.back() > 1) || (this->cols.back() > 1));
+
+    this->counts.assign(size_t(this->cols[0]), 0);
+    this->version = 0U;
+}
+
+void JrLab::LifeDensityPyramid::mark_all() {
+    if (!this->dirty.empty()) {
+        std::fill(this->dirty[0].begin(), this->dirty[0].end(), 1U);
+    }
+}
+
+void JrLab::LifeDensityPyramid::refresh(const std::vector<std::vector<int>>& spans, const std::vector<uint64_t>& versions) {
+    uint64_t latest = this->version;
+
+    for (int r = 0; r < this->row; r ++) {
+        if (versions[r] > this->version) {
+            this->dirty[0][r >> base_shift] = 1;
+            latest = std::max(latest, versions[r]);
+        }
+    }
+
+    this->version = latest;
+
+    for (int level = 0; level < this->levels(); level ++) {
+        std::vector<uint8_t>& flags = this->dirty[level];
+
+        for (int br = 0; br < this->rows[level]; br ++) {
+            if (flags[br] > 0) {
+                if (level == 0) {
+                    this->refresh_base(spans, br);
+                } else {
+                    this->refresh_upper(level, br);
+                }
+
+                // 上一层对应的块行也跟着过期
+                if (level + 1 < this->levels()) {
+                    this->dirty[level + 1][br >> 1] = 1;
+                }
+
+                flags[br] = 0;
+            }
+        }
+    }
+}
+
+size_t JrLab::LifeDensityPyramid::memory_footprint() const {
+    size_t bytes = 0U;
+
+    for (int level = 0; level < this->levels(); level ++) {
+        bytes += this->densities[level].capacity() + this->dirty[level].capacity();
+    }
+
+    bytes += this->counts.capacity() * sizeof(int);
+
+    return bytes;
+}
+
+/*************************************************************************************************/
+void JrLab::LifeDensityPyramid::refresh_base(const std::vector<std::vector<int>>& spans, int br) {
+    int size = 1 << base_shift;
+    int r0 = br * size;
+    int rn = std::min(r0 + size, this->row);
+    uint8_t* dest = this->densities[0].data() + br * this->cols[0];
+
+    std::fill(this->counts.begin(), this->counts.end(), 0);
+
+    // 把每个区间按块的边界切开累加, 不必逐个细胞去数
+    for (int r = r0; r < rn; r ++) {
+        const std::vector<int>& row_spans = spans[r];
+
+        for (size_t idx = 0; idx < row_spans.size(); idx += 2) {
+            int c = row_spans[idx];
+            int cn = row_spans[idx + 1];
+
+            while (c < cn) {
+                int bc = c >> base_shift;
+                int end = std::min((bc + 1) << base_shift, cn);
+
+                this->counts[bc] += end - c;
+                c = end;
+            }
+        }
+    }
+
+    for (int bc = 0; bc < this->cols[0]; bc ++) {
+        int c0 = bc * size;
+        int cn = std::min(c0 + size, this->col);
+
+        // 棋盘边缘的块不完整, 按实际面积计算密度
+        dest[bc] = uint8_t(this->counts[bc] * 255 / ((rn - r0) * (cn - c0)));
+    }
+}
+
+void JrLab::LifeDensityPyramid::refresh_upper(int level, int br) {
+    const std::vector<uint8_t>& lower = this->densities[level - 1];
+    int lrows = this->rows[level - 1];
+    int lcols = this->cols[level - 1];
+    uint8_t* dest = this->densities[level].data() + br * this->cols[level];
+
+    for (int bc = 0; bc < this->cols[level]; bc ++) {
+        int sum = 0;
+        int count = 0;
+
+        for (int lr = br * 2; lr < std::min(br * 2 + 2, lrows); lr ++) {
+            for (int lc = bc * 2; lc < std::min(bc * 2 + 2, lcols); lc ++) {
+                sum += lower[size_t(lr) * size_t(lcols) + size_t(lc)];
+                count ++;
+            }
+        }
+
+        dest[bc] = uint8_t(sum / count);
+    }
+}
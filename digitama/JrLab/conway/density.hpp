@@ -0,0 +1,48 @@
+#pragma once // 确保只被 include 一次
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace JrLab {
+    /**
+     * 生命棋盘的密度金字塔, 缩小观察时代替逐个细胞绘制
+     * 第 0 层每块 8x8 个细胞, 往上每层边长翻倍, 直到一块就能盖住整个棋盘;
+     * 每块存储活细胞密度(0-255), 从每行存活细胞的连续区间统计;
+     * 每行附带一个版本号, 只有版本比上次 refresh 新的行所在的块行才会重新统计
+     */
+    class LifeDensityPyramid {
+    public:
+        LifeDensityPyramid() {}
+
+    public:
+        void resize(int row, int col);
+        void mark_all();
+        void refresh(const std::vector<std::vector<int>>& spans, const std::vector<uint64_t>& versions);
+
+    public:
+        int levels() const { return int(this->densities.size()); }
+        int block_size(int level) const { return 1 << (level + base_shift); }
+        int level_rows(int level) const { return this->rows[level]; }
+        int level_cols(int level) const { return this->cols[level]; }
+        const uint8_t* level_row(int level, int br) const { return this->densities[level].data() + br * this->cols[level]; }
+        size_t memory_footprint() const;
+
+    public:
+        static const int base_shift = 3;
+
+    private:
+        void refresh_base(const std::vector<std::vector<int>>& spans, int br);
+        void refresh_upper(int level, int br);
+
+    private:
+        int row = 0;
+        int col = 0;
+        std::vector<int> rows;
+        std::vector<int> cols;
+        std::vector<std::vector<uint8_t>> densities;
+        std::vector<std::vector<uint8_t>> dirty;
+        std::vector<int> counts;
+        uint64_t version = 0U;
+    };
+}
@@ -0,0 +1,426 @@
+#include "hashlife.hpp"
+
+using namespace JrLab;
+
+/*************************************************************************************************/
+static inline int64_t half_size(int level) {
+    return int64_t(1) << (level - 1);
+}
+
+static inline bool square_disjoint(int64_t x, int64_t y, int level, int row, int col, int64_t x0, int64_t y0) {
+    int64_t size = int64_t(1) << level;
+
+    return (x + size <= x0) || (x >= x0 + col)
+        || (y + size <= y0) || (y >= y0 + row);
+}
+
+static inline void initialize_leaf(HashLifeNode& leaf, uint64_t population) {
+    leaf.nw = leaf.ne = leaf.sw = leaf.se = nullptr;
+    leaf.result = nullptr;
+    leaf.population = population;
+    leaf.level = 0;
+    leaf.marked = false;
+}
+
+/*************************************************************************************************/
+size_t JrLab::HashLifeKeyHash::operator()(const HashLifeKey& key) const {
+    size_t h = reinterpret_cast<size_t>(key.nw);
+
+    h = h * 0x9E3779B1U + reinterpret_cast<size_t>(key.ne);
+    h = h * 0x9E3779B1U + reinterpret_cast<size_t>(key.sw);
+    h = h * 0x9E3779B1U + reinterpret_cast<size_t>(key.se);
+
+    return h ^ (h >> 17);
+}
+
+/*************************************************************************************************/
+JrLab::HashLifeUniverse::HashLifeUniverse(size_t gc_threshold) : gc_threshold(gc_threshold) {
+    initialize_leaf(this->dead, 0U);
+    initialize_leaf(this->alive, 1U);
+
+    this->empties.push_back(&this->dead);
+    this->root = this->empty(3);
+}
+
+JrLab::HashLifeUniverse::~HashLifeUniverse() {
+    for (auto it : this->cache) {
+        delete it.second;
+    }
+}
+
+bool JrLab::HashLifeUniverse::set_rule(const LifeRule& rule) {
+    bool okay = ((rule.birth & 1U) == 0U);
+
+    if (okay && (this->rule != rule)) {
+        this->rule = rule;
+        this->clear_results();
+    }
+
+    return okay;
+}
+
+size_t JrLab::HashLifeUniverse::memory_footprint() {
+    // 每个节点本身, 再加上哈希表的桶和链表节点(键, 值, next 指针)
+    size_t bytes = this->cache.size() * (sizeof(HashLifeNode) + sizeof(HashLifeKey) + sizeof(HashLifeNode*) * 2U);
+
+    bytes += this->cache.bucket_count() * sizeof(void*);
+    bytes += this->empties.capacity() * sizeof(HashLifeNode*);
+
+    return bytes;
+}
+
+void JrLab::HashLifeUniverse::clear() {
+    this->root = this->empty(3);
+}
+
+/*************************************************************************************************/
+int JrLab::HashLifeUniverse::get(int64_t x, int64_t y) {
+    HashLifeNode* node = this->root;
+    int64_t ox = -half_size(node->level);
+    int64_t oy = ox;
+
+    if ((x < ox) || (x >= -ox) || (y < oy) || (y >= -oy)) {
+        return 0;
+    }
+
+    while ((node->level > 0) && (node->population > 0U)) {
+        int64_t h = half_size(node->level);
+
+        if (y < oy + h) {
+            node = (x < ox + h) ? node->nw : node->ne;
+        } else {
+            node = (x < ox + h) ? node->sw : node->se;
+            oy += h;
+        }
+
+        if (x >= ox + h) {
+            ox += h;
+        }
+    }
+
+    return int(node->population);
+}
+
+void JrLab::HashLifeUniverse::set(int64_t x, int64_t y, int state) {
+    int64_t o;
+
+    this->ensure_covered(x, y);
+    o = -half_size(this->root->level);
+    this->root = this->set_node(this->root, o, o, x, y, (state > 0) ? &this->alive : &this->dead);
+}
+
+void JrLab::HashLifeUniverse::paste(int** world, int row, int col, int64_t x0, int64_t y0) {
+    int64_t o;
+
+    this->ensure_covered(x0, y0);
+    this->ensure_covered(x0 + col - 1, y0 + row - 1);
+    o = -half_size(this->root->level);
+    this->root = this->paste_node(this->root, o, o, world, row, col, x0, y0);
+}
+
+bool JrLab::HashLifeUniverse::blit(int** world, int row, int col, int64_t x0, int64_t y0, uint8_t* dirty_rows) {
+    int64_t o = -half_size(this->root->level);
+
+    return this->blit_node(this->root, o, o, world, row, col, x0, y0, dirty_rows);
+}
+
+/*************************************************************************************************/
+bool JrLab::HashLifeUniverse::step(int jump) {
+    HashLifeNode* origin = this->root;
+
+    // 结果缓存只对同一个步长有效
+    if (this->jump != jump) {
+        this->clear_results();
+        this->jump = jump;
+    }
+
+    // 确保世界足够大, 且所有细胞都在中心区域, 演化之后才不会越界
+    while ((this->root->level < jump + 2) || (this->root->population != this->centre(this->root)->population)) {
+        this->root = this->expand(this->root);
+    }
+
+    this->root = this->successor(this->expand(this->root));
+
+    // 补齐到同一层级之后, 相同的世界必然是同一个节点
+    while (origin->level < this->root->level) {
+        origin = this->expand(origin);
+    }
+
+    if (this->cache.size() > this->gc_threshold) {
+        this->collect_garbage();
+    }
+
+    return (origin != this->root);
+}
+
+void JrLab::HashLifeUniverse::collect_garbage() {
+    this->mark(this->root);
+
+    for (auto empty : this->empties) {
+        this->mark(empty);
+    }
+
+    // 先丢弃指向将被回收节点的结果缓存, 再回收
+    for (auto it : this->cache) {
+        HashLifeNode* node = it.second;
+
+        if (node->marked && (node->result != nullptr) && !node->result->marked) {
+            node->result = nullptr;
+        }
+    }
+
+    for (auto it = this->cache.begin(); it != this->cache.end(); ) {
+        HashLifeNode* node = it->second;
+
+        if (node->marked) {
+            node->marked = false;
+            ++ it;
+        } else {
+            delete node;
+            it = this->cache.erase(it);
+        }
+    }
+
+    // 存活节点太多时放宽阈值, 以免每一步都在回收
+    if (this->cache.size() > (this->gc_threshold >> 1)) {
+        this->gc_threshold <<= 1;
+    }
+}
+
+/*************************************************************************************************/
+HashLifeNode* JrLab::HashLifeUniverse::join(HashLifeNode* nw, HashLifeNode* ne, HashLifeNode* sw, HashLifeNode* se) {
+    HashLifeKey key = { nw, ne, sw, se };
+    auto it = this->cache.find(key);
+    HashLifeNode* node = nullptr;
+
+    if (it != this->cache.end()) {
+        node = it->second;
+    } else {
+        node = new HashLifeNode();
+        node->nw = nw;
+        node->ne = ne;
+        node->sw = sw;
+        node->se = se;
+        node->result = nullptr;
+        node->population = nw->population + ne->population + sw->population + se->population;
+        node->level = nw->level + 1;
+        node->marked = false;
+
+        this->cache[key] = node;
+    }
+
+    return node;
+}
+
+HashLifeNode* JrLab::HashLifeUniverse::empty(int level) {
+    while (int(this->empties.size()) <= level) {
+        HashLifeNode* e = this->empties.back();
+
+        this->empties.push_back(this->join(e, e, e, e));
+    }
+
+    return this->empties[level];
+}
+
+HashLifeNode* JrLab::HashLifeUniverse::expand(HashLifeNode* node) {
+    HashLifeNode* e = this->empty(node->level - 1);
+
+    return this->join(this->join(e, e, e, node->nw), this->join(e, e, node->ne, e),
+                      this->join(e, node->sw, e, e), this->join(node->se, e, e, e));
+}
+
+HashLifeNode* JrLab::HashLifeUniverse::centre(HashLifeNode* node) {
+    return this->join(node->nw->se, node->ne->sw, node->sw->ne, node->se->nw);
+}
+
+HashLifeNode* JrLab::HashLifeUniverse::horizontal_centre(HashLifeNode* w, HashLifeNode* e) {
+    return this->join(w->ne, e->nw, w->se, e->sw);
+}
+
+HashLifeNode* JrLab::HashLifeUniverse::vertical_centre(HashLifeNode* n, HashLifeNode* s) {
+    return this->join(n->sw, n->se, s->nw, s->ne);
+}
+
+HashLifeNode* JrLab::HashLifeUniverse::successor(HashLifeNode* node) {
+    if (node->result == nullptr) {
+        if (node->population == 0U) {
+            node->result = node->nw;
+        } else if (node->level == 2) {
+            node->result = this->slow_successor(node);
+        } else {
+            HashLifeNode* n[3][3] = {
+                { node->nw, this->horizontal_centre(node->nw, node->ne), node->ne },
+                { this->vertical_centre(node->nw, node->sw), this->centre(node), this->vertical_centre(node->ne, node->se) },
+                { node->sw, this->horizontal_centre(node->sw, node->se), node->se }
+            };
+
+            // 全速时先各自演化 2^(level - 3) 代, 否则只取中心而不前进
+            for (int i = 0; i < 3; i ++) {
+                for (int j = 0; j < 3; j ++) {
+                    n[i][j] = (this->jump >= node->level - 2) ? this->successor(n[i][j]) : this->centre(n[i][j]);
+                }
+            }
+
+            node->result = this->join(
+                this->successor(this->join(n[0][0], n[0][1], n[1][0], n[1][1])),
+                this->successor(this->join(n[0][1], n[0][2], n[1][1], n[1][2])),
+                this->successor(this->join(n[1][0], n[1][1], n[2][0], n[2][1])),
+                this->successor(this->join(n[1][1], n[1][2], n[2][1], n[2][2])));
+        }
+    }
+
+    return node->result;
+}
+
+HashLifeNode* JrLab::HashLifeUniverse::slow_successor(HashLifeNode* node) {
+    HashLifeNode* quadrants[4] = { node->nw, node->ne, node->sw, node->se };
+    HashLifeNode* next[4];
+    int cells[4][4];
+
+    for (int q = 0; q < 4; q ++) {
+        HashLifeNode* leaves[4] = { quadrants[q]->nw, quadrants[q]->ne, quadrants[q]->sw, quadrants[q]->se };
+
+        for (int l = 0; l < 4; l ++) {
+            cells[(q >> 1) * 2 + (l >> 1)][(q & 1) * 2 + (l & 1)] = int(leaves[l]->population);
+        }
+    }
+
+    // 4x4 的方块演化一代, 得到中心的 2x2
+    for (int idx = 0; idx < 4; idx ++) {
+        int r = 1 + (idx >> 1);
+        int c = 1 + (idx & 1);
+        int n = 0;
+
+        for (int dr = -1; dr <= 1; dr ++) {
+            for (int dc = -1; dc <= 1; dc ++) {
+                n += cells[r + dr][c + dc];
+            }
+        }
+
+        n -= cells[r][c];
+        next[idx] = (this->rule.next_state(cells[r][c], n) > 0) ? &this->alive : &this->dead;
+    }
+
+    return this->join(next[0], next[1], next[2], next[3]);
+}
+
+/*************************************************************************************************/
+HashLifeNode* JrLab::HashLifeUniverse::set_node(HashLifeNode* node, int64_t ox, int64_t oy, int64_t x, int64_t y, HashLifeNode* leaf) {
+    HashLifeNode* nw = node->nw;
+    HashLifeNode* ne = node->ne;
+    HashLifeNode* sw = node->sw;
+    HashLifeNode* se = node->se;
+    int64_t h;
+
+    if (node->level == 0) {
+        return leaf;
+    }
+
+    h = half_size(node->level);
+
+    if (x < ox + h) {
+        if (y < oy + h) {
+            nw = this->set_node(nw, ox, oy, x, y, leaf);
+        } else {
+            sw = this->set_node(sw, ox, oy + h, x, y, leaf);
+        }
+    } else {
+        if (y < oy + h) {
+            ne = this->set_node(ne, ox + h, oy, x, y, leaf);
+        } else {
+            se = this->set_node(se, ox + h, oy + h, x, y, leaf);
+        }
+    }
+
+    return this->join(nw, ne, sw, se);
+}
+
+HashLifeNode* JrLab::HashLifeUniverse::paste_node(HashLifeNode* node, int64_t x, int64_t y, int** world, int row, int col, int64_t x0, int64_t y0) {
+    int64_t h;
+
+    if (square_disjoint(x, y, node->level, row, col, x0, y0)) {
+        return node;
+    } else if (node->level == 0) {
+        return (world[y - y0][x - x0] > 0) ? &this->alive : &this->dead;
+    }
+
+    h = half_size(node->level);
+
+    return this->join(this->paste_node(node->nw, x, y, world, row, col, x0, y0),
+                      this->paste_node(node->ne, x + h, y, world, row, col, x0, y0),
+                      this->paste_node(node->sw, x, y + h, world, row, col, x0, y0),
+                      this->paste_node(node->se, x + h, y + h, world, row, col, x0, y0));
+}
+
+bool JrLab::HashLifeUniverse::blit_node(HashLifeNode* node, int64_t x, int64_t y, int** world, int row, int col, int64_t x0, int64_t y0, uint8_t* dirty_rows) {
+    bool changed = false;
+
+    if (square_disjoint(x, y, node->level, row, col, x0, y0)) {
+        /* 视口之外, 什么都不做 */
+    } else if (node->population == 0U) {
+        int64_t size = int64_t(1) << node->level;
+        int r0 = int(((y > y0) ? y : y0) - y0);
+        int rn = int(((y + size < y0 + row) ? y + size : y0 + row) - y0);
+        int c0 = int(((x > x0) ? x : x0) - x0);
+        int cn = int(((x + size < x0 + col) ? x + size : x0 + col) - x0);
+
+        for (int r = r0; r < rn; r ++) {
+            for (int c = c0; c < cn; c ++) {
+                if (world[r][c] != 0) {
+                    world[r][c] = 0;
+                    changed = true;
+
+                    if (dirty_rows != nullptr) {
+                        dirty_rows[r] = 1;
+                    }
+                }
+            }
+        }
+    } else if (node->level == 0) {
+        int& cell = world[y - y0][x - x0];
+
+        if (cell != 1) {
+            cell = 1;
+            changed = true;
+
+            if (dirty_rows != nullptr) {
+                dirty_rows[y - y0] = 1;
+            }
+        }
+    } else {
+        int64_t h = half_size(node->level);
+
+        changed |= this->blit_node(node->nw, x, y, world, row, col, x0, y0, dirty_rows);
+        changed |= this->blit_node(node->ne, x + h, y, world, row, col, x0, y0, dirty_rows);
+        changed |= this->blit_node(node->sw, x, y + h, world, row, col, x0, y0, dirty_rows);
+        changed |= this->blit_node(node->se, x + h, y + h, world, row, col, x0, y0, dirty_rows);
+    }
+
+    return changed;
+}
+
+void JrLab::HashLifeUniverse::ensure_covered(int64_t x, int64_t y) {
+    int64_t h = half_size(this->root->level);
+
+    while ((x < -h) || (x >= h) || (y < -h) || (y >= h)) {
+        this->root = this->expand(this->root);
+        h = half_size(this->root->level);
+    }
+}
+
+void JrLab::HashLifeUniverse::clear_results() {
+    for (auto it : this->cache) {
+        it.second->result = nullptr;
+    }
+}
+
+void JrLab::HashLifeUniverse::mark(HashLifeNode* node) {
+    if ((node->level > 0) && !node->marked) {
+        node->marked = true;
+
+        this->mark(node->nw);
+        this->mark(node->ne);
+        this->mark(node->sw);
+        this->mark(node->se);
+    }
+}
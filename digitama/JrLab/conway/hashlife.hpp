@@ -0,0 +1,102 @@
+#pragma once // 确保只被 include 一次
+
+#include "rule.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <unordered_map>
+
+namespace JrLab {
+    /** 四叉树节点, 边长为 2^level, 相同内容的节点全局唯一 **/
+    struct HashLifeNode {
+        HashLifeNode* nw;
+        HashLifeNode* ne;
+        HashLifeNode* sw;
+        HashLifeNode* se;
+        HashLifeNode* result;   // 中心区域演化 2^min(jump, level - 2) 代之后的样子
+        uint64_t population;
+        int level;
+        bool marked;
+    };
+
+    struct HashLifeKey {
+        HashLifeNode* nw;
+        HashLifeNode* ne;
+        HashLifeNode* sw;
+        HashLifeNode* se;
+
+        bool operator==(const HashLifeKey& other) const {
+            return (this->nw == other.nw) && (this->ne == other.ne)
+                && (this->sw == other.sw) && (this->se == other.se);
+        }
+    };
+
+    struct HashLifeKeyHash {
+        size_t operator()(const HashLifeKey& key) const;
+    };
+
+    static const int hashlife_max_jump = 62;   // 2^jump 代还要放得进 long long
+
+    /**
+     * HashLife 无界宇宙(默认 B3/S23)
+     * 用带记忆的四叉树表示世界, 一步可以演化 2^jump 代;
+     * 规则不能含 B0, 否则空白区域会凭空诞生细胞, 宇宙不再有"无限远处全是死细胞"的前提;
+     * 宇宙以原点为中心, 坐标 (x, y) 即 (列, 行), 可以向任意方向无限延伸
+     */
+    class HashLifeUniverse {
+    public:
+        HashLifeUniverse(size_t gc_threshold = 1U << 20);
+        virtual ~HashLifeUniverse();
+
+    public:
+        bool set_rule(const JrLab::LifeRule& rule);    // 含 B0 的规则不被接受
+        const JrLab::LifeRule& get_rule() { return this->rule; }
+
+    public:
+        void clear();
+        int get(int64_t x, int64_t y);
+        void set(int64_t x, int64_t y, int state);
+
+    public:
+        void paste(int** world, int row, int col, int64_t x0, int64_t y0);
+        bool blit(int** world, int row, int col, int64_t x0, int64_t y0, uint8_t* dirty_rows = nullptr);
+
+    public:
+        bool step(int jump);    // 演化 2^jump 代(0 <= jump <= hashlife_max_jump), 返回世界是否发生了变化
+        void collect_garbage();
+
+    public:
+        uint64_t population() { return this->root->population; }
+        size_t node_count() { return this->cache.size(); }
+        size_t memory_footprint();
+
+    private:
+        HashLifeNode* join(HashLifeNode* nw, HashLifeNode* ne, HashLifeNode* sw, HashLifeNode* se);
+        HashLifeNode* empty(int level);
+        HashLifeNode* expand(HashLifeNode* node);
+        HashLifeNode* centre(HashLifeNode* node);
+        HashLifeNode* horizontal_centre(HashLifeNode* w, HashLifeNode* e);
+        HashLifeNode* vertical_centre(HashLifeNode* n, HashLifeNode* s);
+        HashLifeNode* successor(HashLifeNode* node);
+        HashLifeNode* slow_successor(HashLifeNode* node);
+
+    private:
+        HashLifeNode* set_node(HashLifeNode* node, int64_t ox, int64_t oy, int64_t x, int64_t y, HashLifeNode* leaf);
+        HashLifeNode* paste_node(HashLifeNode* node, int64_t x, int64_t y, int** world, int row, int col, int64_t x0, int64_t y0);
+        bool blit_node(HashLifeNode* node, int64_t x, int64_t y, int** world, int row, int col, int64_t x0, int64_t y0, uint8_t* dirty_rows);
+        void ensure_covered(int64_t x, int64_t y);
+        void clear_results();
+        void mark(HashLifeNode* node);
+
+    private:
+        std::unordered_map<HashLifeKey, HashLifeNode*, HashLifeKeyHash> cache;
+        std::vector<HashLifeNode*> empties;
+        HashLifeNode dead;
+        HashLifeNode alive;
+        HashLifeNode* root;
+        JrLab::LifeRule rule = JrLab::conway_rule;
+        size_t gc_threshold;
+        int jump = -1;          // 当前结果缓存对应的步长
+    };
+}
@@ -0,0 +1,91 @@
+#include "headless.hpp"
+
+#include <fstream>
+#include <chrono>
+
+using namespace JrLab;
+
+/*************************************************************************************************/
+bool JrLab::probe_life_pattern(const std::string& path, int* row, int* col) {
+    std::ifstream golin(path);
+    bool okay = false;
+
+    if (golin.is_open()) {
+        if (is_life_rle(path, golin)) {
+            LifeRLEHeader header;
+
+            read_life_rle_header(golin, &header);
+            (*row) = header.height;
+            (*col) = header.width;
+        } else {
+            std::string rowline;
+
+            (*row) = 0;
+            (*col) = 0;
+
+            while (std::getline(golin, rowline)) {
+                if ((!rowline.empty()) && (rowline.back() == '\r')) {
+                    rowline.pop_back();
+                }
+
+                (*row) ++;
+                (*col) = (int(rowline.size()) > (*col)) ? int(rowline.size()) : (*col);
+            }
+        }
+
+        okay = ((*row) > 0) && ((*col) > 0);
+    }
+
+    return okay;
+}
+
+void JrLab::load_life_pattern(GameOfLifelet* board, const std::string& path) {
+    std::ifstream golin;
+
+    golin.exceptions(std::ios_base::badbit);
+    golin.open(path);
+
+    if (!golin.is_open()) {
+        throw std::ios_base::failure("cannot open " + path);
+    }
+
+    if (is_life_rle(path, golin)) {
+        board->load_rle(path, golin);
+    } else {
+        board->load(path, golin);
+    }
+}
+
+void JrLab::save_life_pattern(GameOfLifelet* board, const std::string& path) {
+    std::ofstream golout;
+
+    golout.exceptions(std::ios_base::badbit | std::ios_base::failbit);
+    golout.open(path);
+
+    if ((path.size() >= 4) && (path.compare(path.size() - 4, 4, ".rle") == 0)) {
+        board->save_rle(path, golout);
+    } else {
+        board->save(path, golout);
+    }
+}
+
+/*************************************************************************************************/
+LifeRunReport JrLab::run_life_generations(GameOfLifelet* board, long long generations) {
+    LifeRunReport report;
+    long long target = board->get_generation() + generations;
+    long long start = board->get_generation();
+    auto t0 = std::chrono::steady_clock::now();
+
+    while (board->get_generation() < target) {
+        if (!board->pace_forward()) {
+            report.stabilized = true;
+            break;
+        }
+    }
+
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    report.generations = board->get_generation() - start;
+    report.population = board->get_population();
+
+    return report;
+}
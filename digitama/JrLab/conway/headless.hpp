@@ -0,0 +1,25 @@
+#pragma once // 确保只被 include 一次
+
+#include "lifelet.hpp"
+
+#include <string>
+
+namespace JrLab {
+    /** 无窗口批量演化的结果 **/
+    struct LifeRunReport {
+        long long generations = 0;
+        double seconds = 0.0;
+        long long population = 0;
+        bool stabilized = false;    // 还没演化够代数就已经不再变化
+    };
+
+    // 从图案文件本身探测棋盘大小: .gof 按行数和最长的行, RLE 按头部的 x 和 y
+    bool probe_life_pattern(const std::string& path, int* row, int* col);
+
+    // 按扩展名或文件开头选择格式, 读写失败时抛出 std::ios_base::failure
+    void load_life_pattern(JrLab::GameOfLifelet* board, const std::string& path);
+    void save_life_pattern(JrLab::GameOfLifelet* board, const std::string& path);
+
+    // 不限帧率地演化 generations 代, 用的是和窗口版完全相同的演化代码
+    JrLab::LifeRunReport run_life_generations(JrLab::GameOfLifelet* board, long long generations);
+}
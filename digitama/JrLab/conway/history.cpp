@@ -0,0 +1,445 @@
+#include "history.hpp"
+
+#include <algorithm>
+
+using namespace JrLab;
+
+/*************************************************************************************************/
+static const long long keyframe_interval = 64;    // 撤销一步演化最多重放这么多步
+
+static inline void put_varint(std::vector<uint8_t>& bytes, uint64_t n) {
+    while (n >= 0x80U) {
+        bytes.push_back(uint8_t(n | 0x80U));
+        n >>= 7;
+    }
+
+    bytes.push_back(uint8_t(n));
+}
+
+static inline uint64_t get_varint(const std::vector<uint8_t>& bytes, size_t& pos) {
+    uint64_t n = 0U;
+    int shift = 0;
+
+    while (pos < bytes.size()) {
+        uint8_t b = bytes[pos ++];
+
+        n |= uint64_t(b & 0x7FU) << shift;
+        shift += 7;
+
+        if ((b & 0x80U) == 0U) {
+            break;
+        }
+    }
+
+    return n;
+}
+
+// 把按行展开后的 [idx, idx + count) 格子都设成 state
+static inline void fill_cells(int** world, int col, uint64_t idx, uint64_t count, int state) {
+    while (count > 0U) {
+        int r = int(idx / uint64_t(col));
+        int c = int(idx % uint64_t(col));
+        int n = int(std::min(count, uint64_t(col - c)));
+
+        std::fill(world[r] + c, world[r] + c + n, state);
+        idx += uint64_t(n);
+        count -= uint64_t(n);
+    }
+}
+
+/*************************************************************************************************/
+void JrLab::LifeHistory::attach(int** world, int row, int col) {
+    this->world = world;
+    this->row = row;
+    this->col = col;
+}
+
+void JrLab::LifeHistory::restart(long long generation) {
+    this->events.clear();
+    this->keyframes.clear();
+    this->cells.clear();
+    this->cursor = 0U;
+    this->head_generation = generation;
+    this->steps_since_keyframe = 0;
+
+    if (this->enabled()) {
+        this->capture(0U, generation);
+    } else {
+        this->events.shrink_to_fit();
+        this->keyframes.shrink_to_fit();
+        this->cells.shrink_to_fit();
+    }
+}
+
+void JrLab::LifeHistory::record_toggle(int r, int c, int prior, long long generation) {
+    if (this->enabled() && !this->keyframes.empty()) {
+        LifeHistoryEvent event;
+
+        this->truncate();
+
+        event.generation = generation;
+        event.cell0 = this->cells.size();
+        event.celln = event.cell0 + 1U;
+
+        this->cells.push_back((uint64_t(r) * uint64_t(this->col) + uint64_t(c)) * 256U + uint64_t(prior & 0xFF));
+        this->events.push_back(event);
+        this->cursor = this->events.size();
+        this->head_generation = generation;
+        this->trim();
+    }
+}
+
+void JrLab::LifeHistory::record_step(long long generation, long long stride) {
+    if (this->enabled() && !this->keyframes.empty()) {
+        bool sealed = false;
+
+        this->truncate();
+        sealed = (this->keyframes.back().position == this->events.size());
+
+        // 关键帧之后的演化另起一个事件, 这样关键帧总是落在事件的边界上
+        if ((!sealed) && (!this->events.empty()) && (this->events.back().steps > 0) && (this->events.back().stride == stride)
+                && (this->head_generation == generation)) {
+            this->events.back().steps ++;
+        } else {
+            LifeHistoryEvent event;
+
+            event.generation = generation;
+            event.steps = 1;
+            event.stride = stride;
+            event.cell0 = this->cells.size();
+            event.celln = event.cell0;
+
+            this->events.push_back(event);
+        }
+
+        this->cursor = this->events.size();
+        this->head_generation = generation + stride;
+
+        if (++ this->steps_since_keyframe >= keyframe_interval) {
+            this->capture(this->events.size(), this->head_generation);
+            this->steps_since_keyframe = 0;
+        }
+
+        this->trim();
+    }
+}
+
+/*************************************************************************************************/
+bool JrLab::LifeHistory::undo(LifeHistoryEvent* event) {
+    bool okay = (this->cursor > 0U);
+
+    if (okay) {
+        const LifeHistoryEvent& last = this->events[this->cursor - 1U];
+
+        if (last.steps > 1) {
+            this->split(this->cursor - 1U, last.steps - 1);
+        }
+
+        this->cursor --;
+        (*event) = this->events[this->cursor];
+    }
+
+    return okay;
+}
+
+bool JrLab::LifeHistory::redo(LifeHistoryEvent* event) {
+    bool okay = (this->cursor < this->events.size());
+
+    if (okay) {
+        if (this->events[this->cursor].steps > 1) {
+            this->split(this->cursor, 1);
+        }
+
+        (*event) = this->events[this->cursor];
+        this->cursor ++;
+    }
+
+    return okay;
+}
+
+size_t JrLab::LifeHistory::locate(long long generation) {
+    size_t position = 0U;
+
+    for (size_t idx = 0U; idx < this->events.size(); idx ++) {
+        const LifeHistoryEvent& event = this->events[idx];
+
+        if (event.generation > generation) {
+            return position;
+        }
+
+        position = idx;
+
+        // 目标落在一段连续演化的中间, 在那一步拆开
+        if ((event.steps > 0) && (event.generation + event.steps * event.stride > generation)) {
+            long long steps = (generation - event.generation) / event.stride;
+
+            if (steps > 0) {
+                this->split(idx, steps);
+                position = idx + 1U;
+            }
+
+            return position;
+        }
+    }
+
+    return (this->head_generation <= generation) ? this->events.size() : position;
+}
+
+size_t JrLab::LifeHistory::restore(size_t position, long long* generation) {
+    const LifeHistoryKeyframe* keyframe = &this->keyframes.front();
+
+    for (auto& kf : this->keyframes) {
+        if (kf.position <= position) {
+            keyframe = &kf;
+        }
+    }
+
+    switch (keyframe->format) {
+    case LifeKeyframeFormat::Bitmap: {
+        for (int r = 0; r < this->row; r ++) {
+            for (int c = 0; c < this->col; c ++) {
+                uint64_t idx = uint64_t(r) * uint64_t(this->col) + uint64_t(c);
+
+                this->world[r][c] = (keyframe->bytes[idx >> 3] >> (idx & 7U)) & 1;
+            }
+        }
+    }; break;
+    case LifeKeyframeFormat::Bytes: {
+        for (int r = 0; r < this->row; r ++) {
+            for (int c = 0; c < this->col; c ++) {
+                this->world[r][c] = keyframe->bytes[size_t(r) * size_t(this->col) + size_t(c)];
+            }
+        }
+    }; break;
+    default: {
+        uint64_t total = uint64_t(this->row) * uint64_t(this->col);
+        uint64_t idx = 0U;
+        size_t pos = 0U;
+        int state = 0;
+
+        while ((idx < total) && (pos < keyframe->bytes.size())) {
+            uint64_t run = std::min(get_varint(keyframe->bytes, pos), total - idx);
+
+            if (keyframe->format == LifeKeyframeFormat::StateRuns) {
+                state = keyframe->bytes[pos ++];
+            }
+
+            fill_cells(this->world, this->col, idx, run, state);
+            idx += run;
+
+            if (keyframe->format == LifeKeyframeFormat::Runs) {
+                state ^= 1;
+            }
+        }
+
+        fill_cells(this->world, this->col, idx, total - idx, 0);
+    }
+    }
+
+    (*generation) = keyframe->generation;
+
+    return keyframe->position;
+}
+
+void JrLab::LifeHistory::toggled_cell(size_t idx, int* r, int* c, int* prior) const {
+    uint64_t cell = this->cells[idx] >> 8;
+
+    (*r) = int(cell / uint64_t(this->col));
+    (*c) = int(cell % uint64_t(this->col));
+    (*prior) = int(this->cells[idx] & 0xFFU);
+}
+
+size_t JrLab::LifeHistory::memory_footprint() const {
+    size_t bytes = this->events.capacity() * sizeof(LifeHistoryEvent)
+                 + this->keyframes.capacity() * sizeof(LifeHistoryKeyframe)
+                 + this->cells.capacity() * sizeof(uint64_t);
+
+    for (auto& kf : this->keyframes) {
+        bytes += kf.bytes.capacity();
+    }
+
+    return bytes;
+}
+
+/*************************************************************************************************/
+void JrLab::LifeHistory::truncate() {
+    if (this->cursor < this->events.size()) {
+        size_t celln = 0U;
+
+        this->events.resize(this->cursor);
+
+        while ((!this->keyframes.empty()) && (this->keyframes.back().position > this->cursor)) {
+            this->keyframes.pop_back();
+        }
+
+        this->steps_since_keyframe = 0;
+
+        for (size_t idx = 0U; idx < this->events.size(); idx ++) {
+            celln = std::max(celln, this->events[idx].celln);
+
+            if (idx >= this->keyframes.back().position) {
+                this->steps_since_keyframe += this->events[idx].steps;
+            }
+        }
+
+        this->cells.resize(celln);
+
+        if (this->cursor > 0U) {
+            const LifeHistoryEvent& last = this->events.back();
+
+            this->head_generation = last.generation + last.steps * last.stride;
+        } else {
+            this->head_generation = this->keyframes.front().generation;
+        }
+    }
+}
+
+void JrLab::LifeHistory::split(size_t idx, long long first_steps) {
+    LifeHistoryEvent rest = this->events[idx];
+
+    rest.generation += first_steps * rest.stride;
+    rest.steps -= first_steps;
+    this->events[idx].steps = first_steps;
+    this->events.insert(this->events.begin() + (idx + 1U), rest);
+
+    for (auto& kf : this->keyframes) {
+        if (kf.position > idx) {
+            kf.position ++;
+        }
+    }
+
+    if (this->cursor > idx) {
+        this->cursor ++;
+    }
+}
+
+void JrLab::LifeHistory::capture(size_t position, long long generation) {
+    LifeHistoryKeyframe kf;
+    uint64_t total = uint64_t(this->row) * uint64_t(this->col);
+    uint64_t run = 0U;
+    int state = 0;
+    bool multistate = false;
+
+    kf.position = position;
+    kf.generation = generation;
+
+    for (int r = 0; r < this->row; r ++) {
+        const int* cells = this->world[r];
+
+        for (int c = 0; c < this->col; c ++) {
+            if (cells[c] > 1) {
+                multistate = true;
+            }
+        }
+    }
+
+    kf.format = multistate ? LifeKeyframeFormat::StateRuns : LifeKeyframeFormat::Runs;
+
+    for (int r = 0; r < this->row; r ++) {
+        const int* cells = this->world[r];
+
+        for (int c = 0; c < this->col; c ++) {
+            int current = multistate ? cells[c] : ((cells[c] != 0) ? 1 : 0);
+
+            if (current != state) {
+                if (run > 0U) {
+                    put_varint(kf.bytes, run);
+
+                    if (multistate) {
+                        kf.bytes.push_back(uint8_t(state));
+                    }
+                } else if (!multistate) {
+                    put_varint(kf.bytes, 0U);   // 两态游程总是从死细胞开始
+                }
+
+                run = 0U;
+                state = current;
+            }
+
+            run ++;
+        }
+    }
+
+    put_varint(kf.bytes, run);
+
+    if (multistate) {
+        kf.bytes.push_back(uint8_t(state));
+
+        if (kf.bytes.size() > total) {
+            kf.format = LifeKeyframeFormat::Bytes;
+            kf.bytes.resize(size_t(total));
+
+            for (int r = 0; r < this->row; r ++) {
+                for (int c = 0; c < this->col; c ++) {
+                    kf.bytes[size_t(r) * size_t(this->col) + size_t(c)] = uint8_t(this->world[r][c]);
+                }
+            }
+        }
+    } else if (kf.bytes.size() > (total + 7U) / 8U) {
+        kf.format = LifeKeyframeFormat::Bitmap;
+        kf.bytes.assign(size_t((total + 7U) / 8U), 0U);
+
+        for (int r = 0; r < this->row; r ++) {
+            for (int c = 0; c < this->col; c ++) {
+                if (this->world[r][c] != 0) {
+                    uint64_t idx = uint64_t(r) * uint64_t(this->col) + uint64_t(c);
+
+                    kf.bytes[idx >> 3] |= uint8_t(1U << (idx & 7U));
+                }
+            }
+        }
+    }
+
+    kf.bytes.shrink_to_fit();
+    this->keyframes.push_back(std::move(kf));
+}
+
+void JrLab::LifeHistory::drop_oldest() {
+    size_t cut = this->keyframes[1].position;
+    size_t cell_cut = 0U;
+
+    for (size_t idx = 0U; idx < cut; idx ++) {
+        cell_cut = std::max(cell_cut, this->events[idx].celln);
+    }
+
+    this->events.erase(this->events.begin(), this->events.begin() + cut);
+    this->cells.erase(this->cells.begin(), this->cells.begin() + cell_cut);
+    this->keyframes.erase(this->keyframes.begin());
+
+    for (auto& event : this->events) {
+        event.cell0 -= cell_cut;
+        event.celln -= cell_cut;
+    }
+
+    for (auto& kf : this->keyframes) {
+        kf.position -= cut;
+    }
+
+    this->cursor -= cut;
+}
+
+void JrLab::LifeHistory::trim() {
+    while (true) {
+        size_t event_bytes = this->events.size() * sizeof(LifeHistoryEvent) + this->cells.size() * sizeof(uint64_t);
+        size_t usage = event_bytes;
+
+        for (auto& kf : this->keyframes) {
+            usage += kf.bytes.size() + sizeof(LifeHistoryKeyframe);
+        }
+
+        if (usage <= this->budget) {
+            break;
+        }
+
+        if ((this->keyframes.size() > 1U) && (this->keyframes[1].position <= this->cursor)) {
+            this->drop_oldest();
+        } else if ((event_bytes * 2U >= this->budget) && (this->cursor == this->events.size())
+                    && (this->keyframes.back().position < this->cursor)) {
+            // 只剩一张关键帧, 事件本身就占了预算的一半, 在当前位置补拍一张, 之前的就都可以丢掉了
+            this->capture(this->cursor, this->head_generation);
+            this->steps_since_keyframe = 0;
+        } else {
+            break;
+        }
+    }
+}
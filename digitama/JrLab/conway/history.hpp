@@ -0,0 +1,85 @@
+#pragma once // 确保只被 include 一次
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace JrLab {
+    // 历史上的一个事件: 一组细胞切换, 或者连续若干步演化
+    struct LifeHistoryEvent {
+        long long generation = 0;   // 事件发生之前的代数
+        long long steps = 0;        // 0 表示细胞切换, 切换的格子(连同切换之前的状态)是 cells 里的 [cell0, celln)
+        long long stride = 0;       // 每步前进的代数, hashlife 一步前进 2^jump 代
+        size_t cell0 = 0U;
+        size_t celln = 0U;
+    };
+
+    /**
+     * 关键帧的编码
+     * Runs: 交替的死/活游程(变长整数); Bitmap: 比游程还小时直接存位图;
+     * StateRuns: 有衰老状态(Generations 规则)时, 每个游程后面跟一个字节的状态; Bytes: 一个字节一个细胞
+     */
+    enum class LifeKeyframeFormat { Runs, Bitmap, StateRuns, Bytes };
+
+    struct LifeHistoryKeyframe {
+        size_t position = 0U;       // 关键帧是第 position 个事件之前的棋盘
+        long long generation = 0;
+        JrLab::LifeKeyframeFormat format = JrLab::LifeKeyframeFormat::Runs;
+        std::vector<uint8_t> bytes;
+    };
+
+    /**
+     * 生命棋盘的编辑历史(撤销/重做)
+     * 切换细胞只记下格子的编号和原来的状态, 演化只记下步数, 连续的演化合并成一个事件;
+     * 演化不可逆, 撤销演化时从之前最近的关键帧重放, 关键帧每隔一段演化步数拍一张;
+     * 总内存超出预算时丢掉最早的关键帧和它之后的那段事件, 再也退不到那么早了
+     */
+    class LifeHistory {
+    public:
+        LifeHistory() {}
+
+    public:
+        void attach(int** world, int row, int col);
+        void set_budget(size_t bytes) { this->budget = bytes; }
+        bool enabled() const { return (this->budget > 0U) && (this->world != nullptr); }
+        void restart(long long generation);
+
+    public: // 记录新事件会丢掉所有可以重做的事件
+        void record_toggle(int r, int c, int prior, long long generation);
+        void record_step(long long generation, long long stride);
+
+    public: // 游标是已经生效的事件个数
+        bool undo(JrLab::LifeHistoryEvent* event);   // 退回最后一个事件, 连续的演化只退一步
+        bool redo(JrLab::LifeHistoryEvent* event);   // 重做下一个事件, 连续的演化只进一步
+        size_t locate(long long generation);        // 最后一个代数不超过 generation 的位置, 必要时拆开连续的演化
+        size_t restore(size_t position, long long* generation);  // 把 position 之前最近的关键帧写回棋盘, 返回关键帧的位置
+
+    public:
+        const JrLab::LifeHistoryEvent& event_at(size_t position) const { return this->events[position]; }
+        void toggled_cell(size_t idx, int* r, int* c, int* prior) const;
+        size_t get_cursor() const { return this->cursor; }
+        void seek(size_t position) { this->cursor = position; }
+        size_t memory_footprint() const;
+
+    private:
+        void truncate();
+        void split(size_t idx, long long first_steps);
+        void capture(size_t position, long long generation);
+        void drop_oldest();
+        void trim();
+
+    private:
+        int** world = nullptr;
+        int row = 0;
+        int col = 0;
+        size_t budget = 0U;
+
+    private:
+        std::vector<JrLab::LifeHistoryEvent> events;
+        std::vector<JrLab::LifeHistoryKeyframe> keyframes;
+        std::vector<uint64_t> cells;        // 格子编号 * 256 + 切换之前的状态
+        size_t cursor = 0U;
+        long long head_generation = 0;      // 所有事件都生效之后的代数
+        long long steps_since_keyframe = 0;
+    };
+}
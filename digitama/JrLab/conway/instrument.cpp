@@ -0,0 +1,107 @@
+#include "instrument.hpp"
+
+using namespace JrLab;
+
+/*************************************************************************************************/
+void JrLab::LifeInstrument::set_capacity(size_t capacity) {
+    std::lock_guard<std::mutex> guard(this->lock);
+
+    this->capacity = capacity;
+    this->ring.assign(capacity, LifeGenerationSample());
+    this->ring.shrink_to_fit();
+    this->head = 0U;
+    this->count = 0U;
+}
+
+void JrLab::LifeInstrument::clear() {
+    std::lock_guard<std::mutex> guard(this->lock);
+
+    this->head = 0U;
+    this->count = 0U;
+}
+
+/*************************************************************************************************/
+void JrLab::LifeInstrument::record(const LifeGenerationSample& sample) {
+    std::lock_guard<std::mutex> guard(this->lock);
+
+    if (this->capacity > 0U) {
+        this->ring[this->head] = sample;
+        this->head = (this->head + 1U) % this->capacity;
+
+        if (this->count < this->capacity) {
+            this->count ++;
+        }
+    }
+}
+
+void JrLab::LifeInstrument::attribute_sync(long long generation, uint64_t ns) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    LifeGenerationSample* sample = this->find(generation);
+
+    if (sample != nullptr) {
+        sample->sync_ns += ns;
+    }
+}
+
+void JrLab::LifeInstrument::attribute_draw(long long generation, uint64_t ns) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    LifeGenerationSample* sample = this->find(generation);
+
+    if (sample != nullptr) {
+        sample->draw_ns = ns;
+    }
+}
+
+LifeGenerationSample* JrLab::LifeInstrument::find(long long generation) {
+    // 要找的几乎总是最新的那一代, 从新往旧找, 代数比它还小就不用再找了
+    for (size_t i = 1U; i <= this->count; i ++) {
+        LifeGenerationSample& sample = this->ring[(this->head + this->capacity - i) % this->capacity];
+
+        if (sample.generation == generation) {
+            return &sample;
+        } else if (sample.generation < generation) {
+            break;
+        }
+    }
+
+    return nullptr;
+}
+
+/*************************************************************************************************/
+size_t JrLab::LifeInstrument::recent(std::vector<LifeGenerationSample>& samples, size_t n) const {
+    std::lock_guard<std::mutex> guard(this->lock);
+    size_t total = (n < this->count) ? n : this->count;
+
+    samples.resize(total);
+
+    for (size_t i = 0U; i < total; i ++) {
+        samples[i] = this->ring[(this->head + this->capacity - total + i) % this->capacity];
+    }
+
+    return total;
+}
+
+void JrLab::LifeInstrument::write_csv(std::ostream& out) const {
+    std::vector<LifeGenerationSample> samples;
+
+    this->recent(samples, this->size());
+
+    out << "generation,population,births,deaths,evolve_ns,sync_ns,draw_ns\n";
+
+    for (auto& s : samples) {
+        out << s.generation << ',' << s.population << ',' << s.births << ',' << s.deaths << ','
+            << s.evolve_ns << ',' << s.sync_ns << ',' << s.draw_ns << '\n';
+    }
+}
+
+size_t JrLab::LifeInstrument::size() const {
+    std::lock_guard<std::mutex> guard(this->lock);
+
+    return this->count;
+}
+
+size_t JrLab::LifeInstrument::memory_footprint() const {
+    std::lock_guard<std::mutex> guard(this->lock);
+
+    return sizeof(*this) + this->ring.capacity() * sizeof(LifeGenerationSample);
+}
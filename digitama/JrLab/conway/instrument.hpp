@@ -0,0 +1,56 @@
+#pragma once // 确保只被 include 一次
+
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace JrLab {
+    // 一代的测量数据, 时间单位都是纳秒
+    struct LifeGenerationSample {
+        long long generation = 0;
+        long long population = 0;   // 所有非 0 状态的细胞
+        long long births = 0;       // 这一代从 0 变成非 0 的细胞
+        long long deaths = 0;       // 这一代从非 0 变成 0 的细胞
+        uint64_t evolve_ns = 0U;    // 演化引擎算出下一代, 包括同步回 world 矩阵
+        uint64_t sync_ns = 0U;      // 吸收变化清单、循环检测和发布快照
+        uint64_t draw_ns = 0U;      // 最后一次绘制这一代所用的时间, 没画过(全速演化时跳过的代)为 0
+    };
+
+    /**
+     * 生命棋盘的性能记录, 最近 capacity 代的测量数据存在环形缓冲里
+     * 演化线程写入, 界面线程绘制叠加层、补记绘制时间和导出, 所以所有操作都加锁;
+     * 每代只锁一次, 和演化一代的工作量相比可以忽略; 容量为 0(默认)表示不记录
+     */
+    class LifeInstrument {
+    public:
+        LifeInstrument() {}
+
+    public:
+        void set_capacity(size_t capacity);
+        bool enabled() const { return this->capacity > 0U; }
+        void clear();
+
+    public:
+        void record(const JrLab::LifeGenerationSample& sample);
+        void attribute_sync(long long generation, uint64_t ns);    // 发布快照的时间加到第 generation 代上
+        void attribute_draw(long long generation, uint64_t ns);    // 第 generation 代还在缓冲里时记下它的绘制时间
+
+    public:
+        size_t recent(std::vector<JrLab::LifeGenerationSample>& samples, size_t n) const;    // 最近 n 代, 从旧到新
+        void write_csv(std::ostream& out) const;
+        size_t size() const;
+        size_t memory_footprint() const;
+
+    private:
+        JrLab::LifeGenerationSample* find(long long generation);
+
+    private:
+        mutable std::mutex lock;
+        std::vector<JrLab::LifeGenerationSample> ring;
+        size_t capacity = 0U;
+        size_t head = 0U;   // 下一个写入的位置
+        size_t count = 0U;
+    };
+}
@@ -1,78 +1,391 @@
 #include "lifelet.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <new>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 using namespace Plteen;
 using namespace JrLab;
 
 /*************************************************************************************************/
-static inline int count_in_neighbor(int* world[], int row, int col, int r, int c) {
-    return ((r >= 0) && (r < row)
-            && (c >= 0) && (c < col)
-            && (world[r][c] > 0))
-        ? 1 : 0;
+// 四周的光环已经按拓扑填好, 细胞状态只有 0 和 1, 八个邻居直接相加, 不需要任何边界判断
+// 新旧状态的差异顺手按位或起来, 不再需要额外的一遍比较
+template<typename Rule>
+static inline bool evolve_region(const Rule& rule, int** world, int** shadow, int r0, int rn, int c0, int cn, uint8_t* dirty_rows) {
+    bool evolved = false;
+
+    for (int r = r0; r < rn; r ++) {
+        const int* up = world[r - 1];
+        const int* mid = world[r];
+        const int* down = world[r + 1];
+        int* next = shadow[r];
+        int diff = 0;
+
+        for (int c = c0; c < cn; c ++) {
+            int n = up[c - 1] + up[c] + up[c + 1]
+                  + mid[c - 1] + mid[c + 1]
+                  + down[c - 1] + down[c] + down[c + 1];
+
+            next[c] = rule.next_state(mid[c], n);
+            diff |= next[c] ^ mid[c];
+        }
+
+        if (diff != 0) {
+            dirty_rows[r] = 1;
+            evolved = true;
+        }
+    }
+
+    return evolved;
+}
+
+// Generations 规则的标量参照实现, 衰老中的细胞不算活邻居, 所以只数状态为 1 的邻居
+static inline bool evolve_generations_region(const LifeRule& rule, int** world, int** shadow, int r0, int rn, int c0, int cn, uint8_t* dirty_rows) {
+    bool evolved = false;
+
+    for (int r = r0; r < rn; r ++) {
+        const int* up = world[r - 1];
+        const int* mid = world[r];
+        const int* down = world[r + 1];
+        int* next = shadow[r];
+        int diff = 0;
+
+        for (int c = c0; c < cn; c ++) {
+            int n = (up[c - 1] == 1) + (up[c] == 1) + (up[c + 1] == 1)
+                  + (mid[c - 1] == 1) + (mid[c + 1] == 1)
+                  + (down[c - 1] == 1) + (down[c] == 1) + (down[c + 1] == 1);
+
+            next[c] = rule.next_generations_state(mid[c], n);
+            diff |= next[c] ^ mid[c];
+        }
+
+        if (diff != 0) {
+            dirty_rows[r] = 1;
+            evolved = true;
+        }
+    }
+
+    return evolved;
+}
+
+static inline int count_bits(uint64_t word) {
+#ifdef _MSC_VER
+    return int(__popcnt64(word));
+#else
+    return __builtin_popcountll(word);
+#endif
+}
+
+static inline uint64_t elapsed_ns(std::chrono::steady_clock::time_point since) {
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - since).count());
+}
+
+/*************************************************************************************************/
+static const int bands_per_worker = 4;
+static const int tile_size = 32;
+static const size_t cache_line_size = 64U;
+static const int cache_line_ints = int(cache_line_size / sizeof(int));
+static const int cycle_history_size = 128;
+static const float max_cell_size = 64.0F;
+static const float min_cell_size = 1.0F;        // 细胞小于一个像素时改画密度块
+static const float min_grid_cell_size = 4.0F;   // 格子太小时网格线会糊成一片
+static const float min_block_size = 2.0F;
+static const std::chrono::milliseconds publish_interval(15);    // 后台演化时最多每隔这么久发布一次快照
+
+// 每个格子各有一个随机键, 行哈希是该行所有活细胞键的异或
+static inline uint64_t cell_key(uint64_t idx) {
+    uint64_t z = (idx + 1ULL) * 0x9E3779B97F4A7C15ULL;
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+    return z ^ (z >> 31);
 }
 
-static inline int count_neighbors(int *world[], int row, int col, int r, int c) {
-    return count_in_neighbor(world, row, col, r - 1, c + 0)  // up
-         + count_in_neighbor(world, row, col, r + 1, c + 0)  // down
-         + count_in_neighbor(world, row, col, r + 0, c - 1)  // left
-         + count_in_neighbor(world, row, col, r + 0, c + 1)  // right
-         + count_in_neighbor(world, row, col, r - 1, c - 1)  // left-up
-         + count_in_neighbor(world, row, col, r + 1, c + 1)  // right-down
-         + count_in_neighbor(world, row, col, r + 1, c - 1)  // left-down
-         + count_in_neighbor(world, row, col, r - 1, c + 1); // right-up
+// Generations 规则里衰老中的细胞越老越暗, 最老的一级还剩两成亮度
+static inline uint32_t decay_color(uint32_t hex, int state, int states) {
+    float t = float(states - state) / float(states - 1);
+    float k = 0.2F + 0.8F * t;
+    uint32_t red = uint32_t(float((hex >> 16) & 0xFFU) * k);
+    uint32_t green = uint32_t(float((hex >> 8) & 0xFFU) * k);
+    uint32_t blue = uint32_t(float(hex & 0xFFU) * k);
+
+    return (red << 16) | (green << 8) | blue;
 }
 
 /*************************************************************************************************/
 JrLab::GameOfLifelet::~GameOfLifelet() {
-    if (this->world != nullptr) {
-        for (int r = 0; r < this->row; r ++) {
-            delete [] this->world[r];
-        }
+    this->stop_simulation();
 
-        delete [] this->world;
+    if (this->world != nullptr) {
+        delete [] (this->world - 1);
+        delete [] (this->shadow - 1);
+        ::operator delete[](this->cells, std::align_val_t(cache_line_size));
     }
 
-    if (this->shadow != nullptr) {
-        delete [] this->shadow;
+    if (this->workers != nullptr) {
+        delete this->workers;
     }
 }
 
 void JrLab::GameOfLifelet::construct(Plteen::dc_t* dc) {
     IGraphlet::construct(dc);
 
-    this->shadow = new int[this->row * this->col];
-    this->world = new int*[this->row];
+    // 四周各多留一格光环, world[-1] 到 world[row] 和每行的 [-1] 到 [col] 都可以访问;
+    // 两代棋盘挨着放在同一块按缓存行对齐的内存里, world 和 shadow 只是两组行指针;
+    // 每行前面留一整条缓存行(最后一格是左光环), 第 0 列因此对齐到缓存行, 后面至少留一格右光环
+    size_t plane = 0U;
 
-    for (int r = 0; r < this->row; r ++) {
-        this->world[r] = new int[this->col];
+    this->stride = (this->col / cache_line_ints + 2) * cache_line_ints;
+    plane = size_t(this->row + 2) * size_t(this->stride);
+    this->cells = new (std::align_val_t(cache_line_size)) int[plane * 2U]();
+    this->world = new int*[this->row + 2] + 1;
+    this->shadow = new int*[this->row + 2] + 1;
+
+    for (int r = -1; r <= this->row; r ++) {
+        this->world[r] = this->cells + size_t(r + 1) * size_t(this->stride) + size_t(cache_line_ints);
+        this->shadow[r] = this->world[r] + plane;
+    }
+
+    this->dirty_rows.assign(this->row, 1);
+    this->repaint_rows.assign(this->row, 1);
+    this->row_hashes.assign(this->row, 0U);
+    this->live_spans.resize(this->row);
+    this->span_states.resize(this->row);
+    this->span_versions.assign(this->row, 0U);
+    this->history_hashes.assign(cycle_history_size, 0U);
+    this->history_generations.assign(cycle_history_size, 0);
+
+    this->tile_rows = (this->row + tile_size - 1) / tile_size;
+    this->tile_cols = (this->col + tile_size - 1) / tile_size;
+    this->active_tiles.assign(this->tile_rows * this->tile_cols, 1);
+    this->changed_tiles.assign(this->tile_rows * this->tile_cols, 0);
+    this->density.resize(this->row, this->col);
+    this->history.attach(this->world, this->row, this->col);
+
+    if (this->instrument.enabled()) {
+        this->retally();
+    }
+
+    for (int idx = 0; idx < TripleBuffer<LifeSnapshot>::size; idx ++) {
+        this->snapshots.at(idx).spans.resize(this->row);
+        this->snapshots.at(idx).states.resize(this->row);
+        this->snapshots.at(idx).versions.assign(this->row, 0U);
     }
 }
 
 Box JrLab::GameOfLifelet::get_bounding_box() {
-    return { this->gridsize * float(this->col) + 1.0F,
-             this->gridsize * float(this->row) + 1.0F };
+    float width = this->scale * float(this->col);
+    float height = this->scale * float(this->row);
+
+    // 有视口时不超过视口, 缩小到比视口还小的棋盘按实际大小
+    if (this->view_width > 0.0F) {
+        width = flmin(width, this->view_width);
+        height = flmin(height, this->view_height);
+    }
+
+    return { width + 1.0F, height + 1.0F };
 }
 
 void JrLab::GameOfLifelet::draw(Plteen::dc_t* dc, float x, float y, float Width, float Height) {
+    auto start = std::chrono::steady_clock::now();
+    int r0 = this->view_y;
+    int c0 = this->view_x;
+    int rn = this->row;
+    int cn = this->col;
+
     dc->draw_rect(x, y, Width, Height, this->color);
 
-    // 绘制舞台的网格
-    if (!this->hide_grid) {
-        dc->draw_grid(this->row, this->col, this->gridsize, this->gridsize, this->color, x, y);
+    // 只处理视口里的细胞, 绘制量取决于窗口的像素而不是棋盘的大小
+    if (this->view_width > 0.0F) {
+        rn = fxmin(r0 + fl2fxi(std::ceil(this->view_height / this->scale)), this->row);
+        cn = fxmin(c0 + fl2fxi(std::ceil(this->view_width / this->scale)), this->col);
     }
 
-    // 绘制生命状态
-    dc->fill_grid(this->world, this->row, this->col, this->gridsize, this->gridsize, this->color, x, y);
+    if (this->scale >= min_cell_size) {
+        // 绘制舞台的网格
+        if ((!this->hide_grid) && (this->scale >= min_grid_cell_size)) {
+            dc->draw_grid(rn - r0, cn - c0, this->scale, this->scale, this->color, x, y);
+        }
+
+        this->draw_cells(dc, x, y, r0, rn, c0, cn);
+    } else {
+        this->draw_density(dc, x, y, r0, rn, c0, cn);
+    }
+
+    if (this->instrument.enabled()) {
+        this->instrument.attribute_draw(this->get_generation(), elapsed_ns(start));
+    }
+}
+
+void JrLab::GameOfLifelet::draw_cells(Plteen::dc_t* dc, float x, float y, int r0, int rn, int c0, int cn) {
+    const std::vector<std::vector<int>>& rows = this->simulating ? this->snapshots.front().spans : this->live_spans;
+    const std::vector<std::vector<uint8_t>>& row_states = this->simulating ? this->snapshots.front().states : this->span_states;
+    int states = this->get_rule().states;
+
+    // 绘制生命状态, 只重新扫描上次绘制之后变过的行(后台演化时直接用快照), 然后按连续区间整段填充
+    for (int r = r0; r < rn; r ++) {
+        const std::vector<int>& spans = rows[r];
+        float cy = y + float(r - r0) * this->scale;
+        size_t idx;
+
+        if ((!this->simulating) && (this->repaint_rows[r] > 0)) {
+            this->rescan_row(r);
+        }
+
+        // spans 是有序的 [起点, 终点) 序列, 二分找到第一个终点在 c0 右边的区间
+        idx = size_t(std::upper_bound(spans.begin(), spans.end(), c0) - spans.begin()) & ~size_t(1U);
+
+        for (; (idx < spans.size()) && (spans[idx] < cn); idx += 2) {
+            int s = fxmax(spans[idx], c0);
+            int e = fxmin(spans[idx + 1], cn);
+            uint32_t color = this->color;
+
+            // 多态规则的区间按状态切开, 每个区间附带一个状态
+            if (states > 2) {
+                int state = row_states[r][idx / 2];
+
+                if (state > 1) {
+                    color = decay_color(this->color, state, states);
+                }
+            }
+
+            dc->fill_rect(x + float(s - c0) * this->scale, cy,
+                float(e - s) * this->scale, this->scale,
+                color);
+        }
+    }
+}
+
+void JrLab::GameOfLifelet::draw_density(Plteen::dc_t* dc, float x, float y, int r0, int rn, int c0, int cn) {
+    int level = 0;
+    int size;
+    float bsize;
+
+    if (this->simulating) {
+        this->density.refresh(this->snapshots.front().spans, this->snapshots.front().versions);
+    } else {
+        for (int r = 0; r < this->row; r ++) {
+            if (this->repaint_rows[r] > 0) {
+                this->rescan_row(r);
+            }
+        }
+
+        this->density.refresh(this->live_spans, this->span_versions);
+    }
+
+    // 挑一层使每块至少占 min_block_size 个像素
+    while ((level + 1 < this->density.levels())
+            && (float(this->density.block_size(level)) * this->scale < min_block_size)) {
+        level ++;
+    }
+
+    size = this->density.block_size(level);
+    bsize = float(size) * this->scale;
+
+    // 没有半透明可用, 用和密度成正比的面积表示密度, 方块画在所在区块的中央
+    for (int br = r0 / size; br <= (rn - 1) / size; br ++) {
+        const uint8_t* densities = this->density.level_row(level, br);
+        float cy = y + (float(br * size - r0) + float(size) * 0.5F) * this->scale;
+
+        for (int bc = c0 / size; bc <= (cn - 1) / size; bc ++) {
+            if (densities[bc] > 0) {
+                float side = bsize * std::sqrt(float(densities[bc]) / 255.0F);
+                float cx = x + (float(bc * size - c0) + float(size) * 0.5F) * this->scale;
+                float lx = flmax(cx - side * 0.5F, x);
+                float ty = flmax(cy - side * 0.5F, y);
+                float rx = flmin(cx + side * 0.5F, x + float(cn - c0) * this->scale);
+                float by = flmin(cy + side * 0.5F, y + float(rn - r0) * this->scale);
+
+                if ((rx > lx) && (by > ty)) {
+                    dc->fill_rect(lx, ty, rx - lx, by - ty, this->color);
+                }
+            }
+        }
+    }
+}
+
+/*************************************************************************************************/
+void JrLab::GameOfLifelet::set_viewport(float width, float height) {
+    this->view_width = width;
+    this->view_height = height;
+    this->clamp_view();
+    this->notify_updated();
+}
+
+void JrLab::GameOfLifelet::pan(float dx, float dy) {
+    // 视口总是对齐到整数个细胞
+    this->view_x += fl2fxi(flround(dx / this->scale));
+    this->view_y += fl2fxi(flround(dy / this->scale));
+    this->clamp_view();
+    this->notify_updated();
+}
+
+void JrLab::GameOfLifelet::zoom(float factor) {
+    if (this->view_width > 0.0F) {
+        // 缩到整个棋盘刚好放进视口为止, 缩放时保持视口中心的细胞不动
+        float min_scale = flmin(flmin(this->view_width / float(this->col), this->view_height / float(this->row)), this->gridsize);
+        float cx = float(this->view_x) + this->view_width / this->scale * 0.5F;
+        float cy = float(this->view_y) + this->view_height / this->scale * 0.5F;
+
+        this->scale = flmax(flmin(this->scale * factor, max_cell_size), min_scale);
+        this->view_x = fl2fxi(flround(cx - this->view_width / this->scale * 0.5F));
+        this->view_y = fl2fxi(flround(cy - this->view_height / this->scale * 0.5F));
+        this->clamp_view();
+        this->notify_updated();
+    }
+}
+
+void JrLab::GameOfLifelet::reset_view() {
+    this->scale = this->gridsize;
+    this->view_x = 0;
+    this->view_y = 0;
+    this->notify_updated();
+}
+
+void JrLab::GameOfLifelet::clamp_view() {
+    int visible_cols = this->col;
+    int visible_rows = this->row;
+
+    if (this->view_width > 0.0F) {
+        visible_cols = fl2fxi(this->view_width / this->scale);
+        visible_rows = fl2fxi(this->view_height / this->scale);
+    }
+
+    this->view_x = fxmax(fxmin(this->view_x, this->col - visible_cols), 0);
+    this->view_y = fxmax(fxmin(this->view_y, this->row - visible_rows), 0);
 }
 
 void JrLab::GameOfLifelet::toggle_life_at_location(float x, float y) {
-    int c = fl2fxi(flfloor(x / this->gridsize));
-    int r = fl2fxi(flfloor(y / this->gridsize));
+    int c = this->view_x + fl2fxi(flfloor(x / this->scale));
+    int r = this->view_y + fl2fxi(flfloor(y / this->scale));
+
+    if ((r < 0) || (r >= this->row) || (c < 0) || (c >= this->col)) {
+        return;
+    }
 
-    this->world[r][c] = (this->world[r][c] == 0) ? 1 : 0;
+    this->stop_simulation();
+
+    // 衰老中的细胞(Generations 规则)点一下就死, 所以历史里要记下原来的状态
+    this->history.record_toggle(r, c, this->world[r][c], this->generation);
+    this->set_cell(r, c, (this->world[r][c] == 0) ? 1 : 0);
+    this->absorb_changes();
+    this->forget_history();
+    this->on_world_edited(false);
     this->notify_updated();
 }
 
+void JrLab::GameOfLifelet::set_cell(int r, int c, int state) {
+    this->world[r][c] = state;
+    this->dirty_rows[r] = 1;
+    this->activate_tiles_around(r, c);
+}
+
 void JrLab::GameOfLifelet::show_grid(bool yes) {
     if (this->hide_grid == yes) {
         this->hide_grid = !yes;
@@ -87,32 +400,680 @@ void JrLab::GameOfLifelet::set_color(uint32_t hex) {
     }
 }
 
+void JrLab::GameOfLifelet::set_thread_count(int n) {
+    this->stop_simulation();
+
+    if (this->workers != nullptr) {
+        delete this->workers;
+        this->workers = nullptr;
+    }
+
+    // n 为 0 时使用所有的 CPU 核
+    if (n != 1) {
+        this->workers = new WorkPool(n);
+    }
+}
+
 bool JrLab::GameOfLifelet::pace_forward() {
+    this->stop_simulation();
+
+    return this->step();
+}
+
+bool JrLab::GameOfLifelet::step() {
+    auto start = std::chrono::steady_clock::now();
+    long long generations = this->pace_world(this->world, this->shadow, this->row, this->col);
+
+    if (generations > 0) {
+        auto evolved = std::chrono::steady_clock::now();
+
+        if (!this->replaying) {
+            this->history.record_step(this->generation, generations);
+        }
+
+        this->births = 0;
+        this->deaths = 0;
+        this->generation += generations;
+        this->absorb_changes();
+        this->track_cycle();
+
+        if (this->instrument.enabled()) {
+            LifeGenerationSample sample;
+
+            sample.generation = this->generation;
+            sample.population = this->population;
+            sample.births = this->births;
+            sample.deaths = this->deaths;
+            sample.evolve_ns = uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(evolved - start).count());
+            sample.sync_ns = elapsed_ns(evolved);
+
+            this->instrument.record(sample);
+        }
+    }
+
+    return (generations > 0);
+}
+
+long long JrLab::GameOfLifelet::pace_world(int** world, int** shadow, int row, int col) {
     bool evolved = false;
 
-    // 应用演化规则
-    this->evolve(this->world, this->shadow, this->row, this->col);
+    this->refresh_halo();
+
+    // 应用演化规则, 以块行为单位分带, 各带只读 world(包括相邻的光环), 只写自己那几块的 shadow, 顺便记下哪些块发生了变化
+    evolved = this->foreach_band(this->tile_rows, [=](int t0, int tn) {
+        bool changed = false;
+
+        for (int tr = t0; tr < tn; tr ++) {
+            for (int tc = 0; tc < this->tile_cols; tc ++) {
+                int idx = tr * this->tile_cols + tc;
+
+                this->changed_tiles[idx] = 0;
+
+                if (this->active_tiles[idx] > 0) {
+                    int r0 = tr * tile_size;
+                    int c0 = tc * tile_size;
+
+                    if (this->evolve(world, shadow, row, col, r0, fxmin(r0 + tile_size, row), c0, fxmin(c0 + tile_size, col))) {
+                        this->changed_tiles[idx] = 1;
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        return changed;
+    }, 1);
+
+    /**
+     * 交换两组行指针, shadow 就成了新的一代, 不再逐格复制
+     * 没有演化的块在 shadow 里还是上上一代, 但它在上一代没有变化, 上上一代和这一代是一样的;
+     * 编辑过的细胞所在的块总会被激活, 所以这个结论对编辑之后的棋盘也成立
+     */
+    if (evolved) {
+        std::swap_ranges(world - 1, world + row + 1, shadow - 1);
+    }
+
+    this->update_active_tiles();
+
+    return evolved ? 1 : 0;
+}
+
+bool JrLab::GameOfLifelet::foreach_band(int count, const std::function<bool(int, int)>& band_task, int min_band_size) {
+    bool okay = false;
+
+    if (this->workers == nullptr) {
+        okay = band_task(0, count);
+    } else {
+        int band_count = this->workers->size() * bands_per_worker;
+        std::vector<char> results;
+
+        if (band_count > count / min_band_size) {
+            band_count = (count / min_band_size > 0) ? count / min_band_size : 1;
+        }
+
+        results.assign(band_count, 0);
+        this->workers->run(band_count, [&](int band) {
+            int i0 = count * band / band_count;
+            int in = count * (band + 1) / band_count;
+
+            results[band] = band_task(i0, in) ? 1 : 0;
+        });
+
+        for (auto result : results) {
+            okay |= (result != 0);
+        }
+    }
+
+    return okay;
+}
+
+/*************************************************************************************************/
+void JrLab::GameOfLifelet::start_simulation(long long target) {
+    this->stop_simulation();
+
+    if ((target < 0) || (this->generation < target)) {
+        // 先在界面线程发布一次当前的棋盘, 工作线程还没发布快照之前也有东西可画
+        this->publish_snapshot();
+        this->snapshots.acquire();
+
+        this->simulation_stopping.store(false);
+        this->simulation_done.store(false);
+        this->simulating = true;
+        this->simulator = std::thread(&GameOfLifelet::simulate, this, target);
+    }
+}
+
+void JrLab::GameOfLifelet::stop_simulation() {
+    if (this->simulating) {
+        // 工作线程每演化一代都会检查一次, join 之后它对棋盘的所有修改对界面线程都可见
+        this->simulation_stopping.store(true);
+        this->simulator.join();
+        this->simulating = false;
+    }
+}
+
+bool JrLab::GameOfLifelet::sync_simulation() {
+    if (this->simulating) {
+        // 先看工作线程是否已经结束, 这样它结束前发布的最后一个快照也能在这一次取到
+        bool done = this->simulation_done.load(std::memory_order_acquire);
+
+        if (this->snapshots.acquire() || done) {
+            this->notify_updated();
+        }
+
+        if (done) {
+            this->stop_simulation();
+        }
+    }
+
+    return this->simulating;
+}
+
+void JrLab::GameOfLifelet::simulate(long long target) {
+    auto last_published = std::chrono::steady_clock::now();
+    bool stop_on_cycle = (this->period == 0);
+    bool running = true;
+
+    while (running && !this->simulation_stopping.load(std::memory_order_relaxed)) {
+        std::chrono::steady_clock::time_point now;
+
+        running = this->step();
+
+        // 已经停过一次的循环不再拦着, 循环被打破之后才重新留意
+        if (this->period == 0) {
+            stop_on_cycle = true;
+        }
+
+        running = running && ((target < 0) ? !(stop_on_cycle && (this->period > 0)) : (this->generation < target));
+        now = std::chrono::steady_clock::now();
+
+        // 快照只是给人看的, 演化得再快也没必要每一代都发布
+        if ((!running) || (now - last_published >= publish_interval)) {
+            this->publish_snapshot();
+            last_published = now;
+
+            if (this->instrument.enabled()) {
+                this->instrument.attribute_sync(this->generation, elapsed_ns(now));
+            }
+        }
+    }
+
+    this->simulation_done.store(true, std::memory_order_release);
+}
+
+void JrLab::GameOfLifelet::publish_snapshot() {
+    LifeSnapshot& snapshot = this->snapshots.back();
 
-    // 同步舞台状态
     for (int r = 0; r < this->row; r ++) {
-        for (int c = 0; c < this->col; c ++) {
-            int state = this->shadow[r * this->col + c];
+        if (this->repaint_rows[r] > 0) {
+            this->rescan_row(r);
+        }
+    }
+
+    // back 可能是两次发布之前的旧快照, 按版本号补上它之后变过的行
+    for (int r = 0; r < this->row; r ++) {
+        if (this->span_versions[r] > snapshot.version) {
+            snapshot.spans[r] = this->live_spans[r];
+            snapshot.states[r] = this->span_states[r];
+            snapshot.versions[r] = this->span_versions[r];
+        }
+    }
+
+    snapshot.version = this->span_version;
+    snapshot.generation = this->generation;
+    snapshot.period = this->period;
+
+    this->snapshots.publish();
+}
+
+/*************************************************************************************************/
+void JrLab::GameOfLifelet::mark_all_rows_dirty() {
+    std::fill(this->dirty_rows.begin(), this->dirty_rows.end(), 1);
+    this->absorb_changes();
+    this->forget_history();
+}
 
-            if (this->world[r][c] != state) {
-                this->world[r][c] = state;
-                evolved = true;
+void JrLab::GameOfLifelet::absorb_changes() {
+    bool tallying = this->instrument.enabled();
+
+    // 只有变过的行才需要重新计算行哈希和出生死亡数, 各行互不干扰, 可以分带并行
+    if (this->cycle_detection || tallying) {
+        this->foreach_band(this->row, [=](int r0, int rn) {
+            for (int r = r0; r < rn; r ++) {
+                if ((this->dirty_rows[r] > 0) && tallying) {
+                    this->tally_row(r);
+                }
+
+                if ((this->dirty_rows[r] > 0) && this->cycle_detection) {
+                    uint64_t base = uint64_t(r) * uint64_t(this->col);
+                    int* cells = this->world[r];
+                    uint64_t h = 0U;
+
+                    // 多态规则里同一格子的不同状态要算成不同的棋盘
+                    for (int c = 0; c < this->col; c ++) {
+                        if (cells[c] > 0) {
+                            h ^= cell_key((base + uint64_t(c)) * 256U + uint64_t(cells[c]));
+                        }
+                    }
+
+                    this->row_hashes[r] = h;
+                }
+            }
+
+            return false;
+        });
+
+        if (this->cycle_detection) {
+            this->world_hash = 0U;
+            for (int r = 0; r < this->row; r ++) {
+                this->world_hash ^= this->row_hashes[r];
             }
         }
     }
 
-    if (evolved) {
-        this->generation ++;
+    for (int r = 0; r < this->row; r ++) {
+        if (this->dirty_rows[r] > 0) {
+            if (tallying) {
+                this->births += this->row_births[r];
+                this->deaths += this->row_deaths[r];
+                this->population += this->row_births[r] - this->row_deaths[r];
+            }
+
+            this->repaint_rows[r] = 1;
+            this->dirty_rows[r] = 0;
+        }
     }
+}
 
-    return evolved;
+void JrLab::GameOfLifelet::rescan_row(int r) {
+    std::vector<int>& spans = this->live_spans[r];
+    std::vector<uint8_t>& states = this->span_states[r];
+    bool multistate = (this->get_rule().states > 2);
+    int* cells = this->world[r];
+    int c = 0;
+
+    spans.clear();
+    states.clear();
+    this->span_versions[r] = ++ this->span_version;
+
+    // 区间在状态变化的地方断开, 两态规则里非 0 的状态只有 1, 和按存活与否切分是一样的
+    while (c < this->col) {
+        if (cells[c] > 0) {
+            int c0 = c;
+            int state = cells[c];
+
+            while ((c < this->col) && (cells[c] == state)) {
+                c ++;
+            }
+
+            spans.push_back(c0);
+            spans.push_back(c);
+
+            if (multistate) {
+                states.push_back(uint8_t(state));
+            }
+        } else {
+            c ++;
+        }
+    }
+
+    this->repaint_rows[r] = 0;
+}
+
+/*************************************************************************************************/
+void JrLab::GameOfLifelet::set_instrument_capacity(size_t generations) {
+    this->stop_simulation();
+
+    this->instrument.set_capacity(generations);
+
+    if (this->instrument.enabled() && (this->world != nullptr)) {
+        this->retally();
+    } else {
+        this->alive_bits.clear();
+        this->alive_bits.shrink_to_fit();
+    }
+}
+
+void JrLab::GameOfLifelet::retally() {
+    this->alive_words = (this->col + 63) / 64;
+    this->alive_bits.assign(size_t(this->row) * size_t(this->alive_words), 0ULL);
+    this->row_births.assign(this->row, 0);
+    this->row_deaths.assign(this->row, 0);
+    this->population = 0;
+
+    // 从空白的位图开始比, 每个活细胞都算一次出生, 出生总数就是人口
+    for (int r = 0; r < this->row; r ++) {
+        this->tally_row(r);
+        this->population += this->row_births[r];
+    }
+
+    this->births = 0;
+    this->deaths = 0;
+}
+
+void JrLab::GameOfLifelet::tally_row(int r) {
+    uint64_t* bits = this->alive_bits.data() + size_t(r) * size_t(this->alive_words);
+    const int* cells = this->world[r];
+    int born = 0;
+    int dead = 0;
+
+    for (int w = 0; w < this->alive_words; w ++) {
+        int c0 = w * 64;
+        int cn = fxmin(c0 + 64, this->col);
+        uint64_t word = 0ULL;
+
+        for (int c = c0; c < cn; c ++) {
+            word |= uint64_t(cells[c] != 0) << (c - c0);
+        }
+
+        born += count_bits(word & ~bits[w]);
+        dead += count_bits(bits[w] & ~word);
+        bits[w] = word;
+    }
+
+    this->row_births[r] = born;
+    this->row_deaths[r] = dead;
+}
+
+/*************************************************************************************************/
+void JrLab::GameOfLifelet::set_cycle_detection(bool yes) {
+    // hashlife 的棋盘只是视口, 活动离开视口之后视口里的哈希会误报周期, 干脆不检测
+    yes = yes && this->is_board_whole_world();
+
+    if (this->cycle_detection != yes) {
+        this->stop_simulation();
+
+        this->cycle_detection = yes;
+
+        if (yes && (this->world != nullptr)) {
+            this->mark_all_rows_dirty();
+        }
+    }
+}
+
+void JrLab::GameOfLifelet::track_cycle() {
+    if (this->cycle_detection) {
+        int steps = 0;
+
+        // 找最近一次出现过的同一个棋盘
+        for (int i = 1; i <= this->history_count; i ++) {
+            int idx = (this->history_head - i + cycle_history_size) % cycle_history_size;
+
+            if (this->history_hashes[idx] == this->world_hash) {
+                int p = int(this->generation - this->history_generations[idx]);
+
+                if (p == this->candidate_period) {
+                    this->period_streak ++;
+                } else {
+                    this->candidate_period = p;
+                    this->period_streak = 1;
+                }
+
+                steps = i;
+                break;
+            }
+        }
+
+        // 连续一整个周期的每一步都和上个周期吻合才算确认, 以免哈希碰撞造成误判
+        if (steps == 0) {
+            this->candidate_period = 0;
+            this->period_streak = 0;
+            this->period = 0;
+        } else if (this->period_streak >= steps) {
+            this->period = this->candidate_period;
+        }
+
+        this->history_hashes[this->history_head] = this->world_hash;
+        this->history_generations[this->history_head] = this->generation;
+        this->history_head = (this->history_head + 1) % cycle_history_size;
+        this->history_count = fxmin(this->history_count + 1, cycle_history_size);
+    }
+}
+
+void JrLab::GameOfLifelet::forget_history() {
+    this->history_head = 0;
+    this->history_count = 0;
+    this->candidate_period = 0;
+    this->period_streak = 0;
+    this->period = 0;
+}
+
+/*************************************************************************************************/
+void JrLab::GameOfLifelet::set_history_budget(size_t bytes) {
+    this->stop_simulation();
+
+    // 关键帧只拍得下棋盘, hashlife 重放之后视口之外的宇宙就没了, 所以不给它记录历史
+    this->history.set_budget(this->is_board_whole_world() ? bytes : 0U);
+    this->history.restart(this->generation);
+}
+
+bool JrLab::GameOfLifelet::undo() {
+    LifeHistoryEvent event;
+    bool okay = false;
+
+    this->stop_simulation();
+
+    if (this->history.undo(&event)) {
+        // 切换细胞直接改回原来的状态, 演化不可逆, 只能从关键帧重放
+        if (event.steps == 0) {
+            this->apply_history_toggles(event, true);
+        } else {
+            this->replay_history(this->history.get_cursor());
+        }
+
+        okay = true;
+    }
+
+    return okay;
+}
+
+bool JrLab::GameOfLifelet::redo() {
+    LifeHistoryEvent event;
+    bool okay = false;
+
+    this->stop_simulation();
+
+    if (this->history.redo(&event)) {
+        if (event.steps == 0) {
+            this->apply_history_toggles(event, false);
+        } else {
+            this->replaying = true;
+            this->step();
+            this->replaying = false;
+            this->notify_updated();
+        }
+
+        okay = true;
+    }
+
+    return okay;
+}
+
+bool JrLab::GameOfLifelet::rewind(long long generation) {
+    bool okay = false;
+
+    this->stop_simulation();
+
+    if (this->history.enabled()) {
+        size_t position = this->history.locate(generation);
+
+        if (position != this->history.get_cursor()) {
+            this->history.seek(position);
+            this->replay_history(position);
+            okay = true;
+        }
+    }
+
+    return okay;
+}
+
+void JrLab::GameOfLifelet::write_history_toggles(const LifeHistoryEvent& event, bool reverting) {
+    for (size_t idx = event.cell0; idx < event.celln; idx ++) {
+        int r, c, prior;
+
+        this->history.toggled_cell(idx, &r, &c, &prior);
+        this->set_cell(r, c, reverting ? prior : ((prior == 0) ? 1 : 0));
+    }
+}
+
+void JrLab::GameOfLifelet::apply_history_toggles(const LifeHistoryEvent& event, bool reverting) {
+    this->write_history_toggles(event, reverting);
+    this->absorb_changes();
+    this->forget_history();
+    this->on_world_edited(false);
+    this->notify_updated();
+}
+
+void JrLab::GameOfLifelet::replay_history(size_t position) {
+    size_t idx = this->history.restore(position, &this->generation);
+
+    this->activate_tiles(true);
+    this->mark_all_rows_dirty();
+    this->on_world_edited(true);
+
+    // 重放不能再记进历史里
+    this->replaying = true;
+
+    for (; idx < position; idx ++) {
+        const LifeHistoryEvent& event = this->history.event_at(idx);
+
+        if (event.steps == 0) {
+            this->write_history_toggles(event, false);
+            this->absorb_changes();
+            this->on_world_edited(false);
+        } else {
+            for (long long s = 0; s < event.steps; s ++) {
+                this->step();
+            }
+        }
+    }
+
+    this->replaying = false;
+    this->forget_history();
+    this->notify_updated();
+}
+
+/*************************************************************************************************/
+void JrLab::GameOfLifelet::activate_tiles(bool yes) {
+    std::fill(this->active_tiles.begin(), this->active_tiles.end(), yes ? 1 : 0);
+}
+
+void JrLab::GameOfLifelet::activate_tiles_around(int r, int c) {
+    int tr = r / tile_size;
+    int tc = c / tile_size;
+
+    for (int dr = -1; dr <= 1; dr ++) {
+        for (int dc = -1; dc <= 1; dc ++) {
+            if ((tr + dr >= 0) && (tr + dr < this->tile_rows) && (tc + dc >= 0) && (tc + dc < this->tile_cols)) {
+                this->active_tiles[(tr + dr) * this->tile_cols + (tc + dc)] = 1;
+            }
+        }
+    }
+
+    if (this->is_border_tile(tr, tc)) {
+        this->activate_border_tiles();
+    }
+}
+
+bool JrLab::GameOfLifelet::is_border_tile(int tr, int tc) {
+    return (this->topology != LifeTopology::Dead)
+        && ((tr == 0) || (tr == this->tile_rows - 1) || (tc == 0) || (tc == this->tile_cols - 1));
+}
+
+void JrLab::GameOfLifelet::activate_border_tiles() {
+    // 边界相接时, 边上的区块可能和对面任何一个边上的区块相邻(克莱因瓶还要左右翻转), 干脆整圈一起激活
+    for (int tc = 0; tc < this->tile_cols; tc ++) {
+        this->active_tiles[tc] = 1;
+        this->active_tiles[(this->tile_rows - 1) * this->tile_cols + tc] = 1;
+    }
+
+    for (int tr = 0; tr < this->tile_rows; tr ++) {
+        this->active_tiles[tr * this->tile_cols] = 1;
+        this->active_tiles[tr * this->tile_cols + this->tile_cols - 1] = 1;
+    }
+}
+
+void JrLab::GameOfLifelet::update_active_tiles() {
+    bool border_changed = false;
+
+    // 下一代只需演化自己或八个邻居刚刚发生过变化的区块
+    for (int tr = 0; tr < this->tile_rows; tr ++) {
+        for (int tc = 0; tc < this->tile_cols; tc ++) {
+            uint8_t active = 0;
+
+            for (int dr = -1; dr <= 1; dr ++) {
+                for (int dc = -1; dc <= 1; dc ++) {
+                    if ((tr + dr >= 0) && (tr + dr < this->tile_rows) && (tc + dc >= 0) && (tc + dc < this->tile_cols)) {
+                        active |= this->changed_tiles[(tr + dr) * this->tile_cols + (tc + dc)];
+                    }
+                }
+            }
+
+            this->active_tiles[tr * this->tile_cols + tc] = active;
+
+            if ((this->changed_tiles[tr * this->tile_cols + tc] > 0) && this->is_border_tile(tr, tc)) {
+                border_changed = true;
+            }
+        }
+    }
+
+    if (border_changed) {
+        this->activate_border_tiles();
+    }
+}
+
+/*************************************************************************************************/
+void JrLab::GameOfLifelet::set_topology(LifeTopology topology) {
+    if (this->topology != topology) {
+        this->stop_simulation();
+        this->topology = topology;
+
+        // 边界条件变了, 原本静止的区块也可能跟着变化
+        if (this->world != nullptr) {
+            this->activate_tiles(true);
+            this->forget_history();
+            this->on_world_edited(false);
+        }
+    }
+}
+
+void JrLab::GameOfLifelet::refresh_halo() {
+    int** world = this->world;
+    int row = this->row;
+    int col = this->col;
+
+    // 先补左右两列, 上下两行连同四个角一起从补好的行里复制
+    for (int r = 0; r < row; r ++) {
+        if (this->topology == LifeTopology::Dead) {
+            world[r][-1] = 0;
+            world[r][col] = 0;
+        } else {
+            world[r][-1] = world[r][col - 1];
+            world[r][col] = world[r][0];
+        }
+    }
+
+    for (int c = -1; c <= col; c ++) {
+        switch (this->topology) {
+        case LifeTopology::Torus: {
+            world[-1][c] = world[row - 1][c];
+            world[row][c] = world[0][c];
+        }; break;
+        case LifeTopology::Klein: {
+            world[-1][c] = world[row - 1][col - 1 - c];
+            world[row][c] = world[0][col - 1 - c];
+        }; break;
+        default: {
+            world[-1][c] = 0;
+            world[row][c] = 0;
+        }
+        }
+    }
 }
 
 void JrLab::GameOfLifelet::reset() {
+    this->stop_simulation();
+
     this->generation = 0;
 
     for (int r = 0; r < this->row; r ++) {
@@ -120,76 +1081,319 @@ void JrLab::GameOfLifelet::reset() {
             this->world[r][c] = 0;
         }
     }
+
+    this->activate_tiles(true);
+    this->mark_all_rows_dirty();
+    this->on_world_edited(true);
+    this->history.restart(this->generation);
 }
 
 void JrLab::GameOfLifelet::construct_random_world() {
+    this->stop_simulation();
+
+    // 一次生成一整行的随机位, 每个 64 位的字管 64 个细胞
+    this->random_bits.resize(size_t(this->col + 63) / 64U);
+
     for (int r = 0; r < this->row; r++) {
+        this->random.fill(this->random_bits.data(), this->random_bits.size());
+
         for (int c = 0; c < this->col; c++) {
-            this->world[r][c] = ((random_raw() % 2 == 0) ? 1 : 0);
+            this->world[r][c] = int((this->random_bits[c >> 6] >> (c & 63)) & 1U);
         }
     }
 
     this->generation = 0;
+    this->activate_tiles(true);
+    this->mark_all_rows_dirty();
+    this->on_world_edited(true);
+    this->history.restart(this->generation);
 }
 
-void JrLab::GameOfLifelet::load(const std::string& life_world, std::ifstream& golin) {
+void JrLab::GameOfLifelet::load(const std::string& life_world, std::istream& golin) {
+    std::ios_base::iostate mask = golin.exceptions();
     std::string rowline;
+    int states = this->get_rule().states;
     int r = 0;
 
     this->reset();
 
+    // 棋盘可能比文件行数多, 读到文件末尾就停下, 不能让 failbit 异常跳过后面的收尾工作
+    golin.exceptions(std::ios_base::badbit);
+
+    // 多态规则的衰老状态存成数字 2-9, 其他非 0 的字符都是活细胞
     while ((r < this->row) && std::getline(golin, rowline)) {
         for (int c = 0; c < rowline.size() && c < this->col; c ++) {
-            this->world[r][c] = (rowline[c] == '0') ? 0 : 1;
+            int state = rowline[c] - '0';
+
+            this->world[r][c] = (state == 0) ? 0 : (((state > 1) && (state < states)) ? state : 1);
         }
 
         r ++;
     }
+
+    // 先清掉 eof 和 fail 再恢复异常设置, 否则恢复的那一刻就会抛出来
+    golin.clear();
+    golin.exceptions(mask);
+
+    this->activate_tiles(true);
+    this->mark_all_rows_dirty();
+    this->on_world_edited(true);
+    this->history.restart(this->generation);
 }
 
-void JrLab::GameOfLifelet::save(const std::string& life_world, std::ofstream& golout) {
+void JrLab::GameOfLifelet::save(const std::string& life_world, std::ostream& golout) {
+    this->stop_simulation();
+
     if (world != nullptr) {
+        std::string rowline(size_t(this->col) + 1U, '\n');
+
+        // 整行拼好之后一次写出, 不再逐个细胞格式化, 也不再每行都刷新缓冲区
         for (int r = 0; r < this->row; r++) {
             for (int c = 0; c < this->col; c++) {
-                golout << this->world[r][c];
+                rowline[c] = char('0' + fxmin(this->world[r][c], 9));
             }
             
-            golout << std::endl;
+            golout.write(rowline.data(), std::streamsize(rowline.size()));
         }
     }
 }
 
-/*************************************************************************************************/
-void JrLab::ConwayLifelet::evolve(int** world, int* shadow, int row, int col) {
-    for (int r = 0; r < row; r ++) {
-        for (int c = 0; c < col; c ++) {
-            int n = count_neighbors(world, row, col, r, c);
-            int i = r * col + c;
+void JrLab::GameOfLifelet::load_rle(const std::string& life_world, std::istream& golin) {
+    LifeRLEHeader header;
+    int states = this->get_rule().states;
+    int r0 = 0;
+    int c0 = 0;
 
-            if (n < 2) {            // 孤独死(离群索居)
-                shadow[i] = 0;
-            } else if (n > 3) {     // 内卷死(过度竞争)
-                shadow[i] = 0;
-            } else if (n == 3) {    // 无性繁殖
-                shadow[i] = 1;
-            } else {                // 安居乐业
-                shadow[i] = world[r][c];
+    this->reset();
+    read_life_rle_header(golin, &header);
+
+    // RLE 图案没有绝对位置, 能放得下就居中
+    if ((header.height > 0) && (header.height < this->row)) {
+        r0 = (this->row - header.height) / 2;
+    }
+
+    if ((header.width > 0) && (header.width < this->col)) {
+        c0 = (this->col - header.width) / 2;
+    }
+
+    // 与 .gof 一样, 当前规则容纳不下的状态都当作活细胞
+    read_life_rle_body(golin, [this, r0, c0, states](int r, int cs, int ce, int state) {
+        r += r0;
+
+        if ((r >= 0) && (r < this->row)) {
+            int* cells = this->world[r];
+            int cell = (state < states) ? state : 1;
+
+            for (int c = fxmax(cs + c0, 0); c < fxmin(ce + c0, this->col); c ++) {
+                cells[c] = cell;
             }
         }
+    });
+
+    this->activate_tiles(true);
+    this->mark_all_rows_dirty();
+    this->on_world_edited(true);
+    this->history.restart(this->generation);
+}
+
+void JrLab::GameOfLifelet::save_rle(const std::string& life_world, std::ostream& golout) {
+    this->stop_simulation();
+
+    if (world != nullptr) {
+        write_life_rle(golout, this->world, this->row, this->col, life_rule_to_string(this->get_rule()), this->get_rule().states);
     }
 }
 
-void JrLab::HighLifelet::evolve(int** world, int* shadow, int row, int col) {
-    for (int r = 0; r < row; r ++) {
-        for (int c = 0; c < col; c ++) {
-            int n = count_neighbors(world, row, col, r, c);
-            int i = r * col + c;
+long long JrLab::GameOfLifelet::get_population() {
+    long long population = 0;
+
+    this->stop_simulation();
 
-            switch (n) {
-            case 2: shadow[i] = world[r][c]; break;
-            case 3: case 6: shadow[i] = 1; break;
-            default: shadow[i] = 0;
+    if (world != nullptr) {
+        for (int r = 0; r < this->row; r++) {
+            for (int c = 0; c < this->col; c++) {
+                if (this->world[r][c] > 0) {
+                    population ++;
+                }
             }
         }
     }
+
+    return population;
+}
+
+size_t JrLab::GameOfLifelet::get_memory_footprint() {
+    size_t bytes = sizeof(*this);
+
+    bytes += size_t(this->row + 2) * size_t(this->stride) * sizeof(int) * 2U;   // world 和 shadow
+    bytes += size_t(this->row + 2) * sizeof(int*) * 2U;
+    bytes += this->dirty_rows.capacity() + this->repaint_rows.capacity();
+    bytes += this->active_tiles.capacity() + this->changed_tiles.capacity();
+    bytes += (this->row_hashes.capacity() + this->history_hashes.capacity()) * sizeof(uint64_t);
+    bytes += this->history_generations.capacity() * sizeof(long long);
+    bytes += this->span_versions.capacity() * sizeof(uint64_t) * size_t(TripleBuffer<LifeSnapshot>::size + 1);
+
+    for (auto& spans : this->live_spans) {
+        bytes += sizeof(spans) + spans.capacity() * sizeof(int);
+    }
+
+    bytes += this->density.memory_footprint();
+    bytes += this->history.memory_footprint();
+    bytes += this->instrument.memory_footprint();
+    bytes += this->alive_bits.capacity() * sizeof(uint64_t);
+    bytes += (this->row_births.capacity() + this->row_deaths.capacity()) * sizeof(int);
+
+    return bytes;
+}
+
+/*************************************************************************************************/
+bool JrLab::RuleLifelet::evolve(int** world, int** shadow, int row, int col, int r0, int rn, int c0, int cn) {
+    const LifeRule rule = this->rule;
+    bool evolved = false;
+
+    if (rule.states > 2) {
+        evolved = evolve_generations_region(rule, world, shadow, r0, rn, c0, cn, this->row_dirty_flags());
+    } else {
+        evolved = evolve_region(rule, world, shadow, r0, rn, c0, cn, this->row_dirty_flags());
+    }
+
+    return evolved;
+}
+
+template<uint16_t Birth, uint16_t Survival>
+bool JrLab::StaticRuleLifelet<Birth, Survival>::evolve(int** world, int** shadow, int row, int col, int r0, int rn, int c0, int cn) {
+    constexpr LifeRule rule { Birth, Survival };
+
+    return evolve_region(rule, world, shadow, r0, rn, c0, cn, this->row_dirty_flags());
+}
+
+template class JrLab::StaticRuleLifelet<conway_rule.birth, conway_rule.survival>;
+template class JrLab::StaticRuleLifelet<highlife_rule.birth, highlife_rule.survival>;
+template class JrLab::StaticRuleLifelet<seeds_rule.birth, seeds_rule.survival>;
+template class JrLab::StaticRuleLifelet<day_and_night_rule.birth, day_and_night_rule.survival>;
+
+/*************************************************************************************************/
+long long JrLab::BitwiseLifelet::pace_world(int** world, int** shadow, int row, int col) {
+    bool evolved = false;
+
+    // 棋盘被编辑过, 重新打包
+    if (this->stale) {
+        this->bits.pack(world, row, col);
+        this->stale = false;
+    }
+
+    this->bits.set_topology(this->get_topology());
+    this->bits.refresh_halo();
+
+    evolved = this->foreach_band(row, [this](int r0, int rn) {
+        return this->bits.evolve_rows(r0, rn);
+    });
+
+    this->bits.swap_generation();
+
+    // 只把发生变化的细胞同步回舞台
+    if (evolved) {
+        this->foreach_band(row, [=](int r0, int rn) {
+            this->bits.unpack_changes(world, r0, rn, this->row_dirty_flags());
+            return false;
+        });
+    }
+
+    return evolved ? 1 : 0;
+}
+
+/*************************************************************************************************/
+long long JrLab::GenerationsLifelet::pace_world(int** world, int** shadow, int row, int col) {
+    bool evolved = false;
+
+    if (this->stale) {
+        this->bytes.pack(world, row, col);
+        this->stale = false;
+    }
+
+    this->bytes.set_topology(this->get_topology());
+    this->bytes.refresh_halo();
+
+    evolved = this->foreach_band(row, [this](int r0, int rn) {
+        return this->bytes.evolve_rows(r0, rn);
+    });
+
+    this->bytes.swap_generation();
+
+    if (evolved) {
+        this->foreach_band(row, [=](int r0, int rn) {
+            this->bytes.unpack_changes(world, r0, rn, this->row_dirty_flags());
+            return false;
+        });
+    }
+
+    return evolved ? 1 : 0;
+}
+
+/*************************************************************************************************/
+long long JrLab::HashLifelet::pace_world(int** world, int** shadow, int row, int col) {
+    long long generations = 0;
+
+    // 只把视口里的编辑贴回宇宙, 视口之外的部分保持原样
+    if (this->stale) {
+        this->universe.paste(world, row, col, 0, 0);
+        this->stale = false;
+    }
+
+    if (this->universe.step(this->jump)) {
+        this->universe.blit(world, row, col, 0, 0, this->row_dirty_flags());
+        generations = 1LL << this->jump;
+    }
+
+    return generations;
+}
+
+void JrLab::HashLifelet::on_world_edited(bool renewed) {
+    // 整个世界被重建, 视口之外的部分也要清空
+    if (renewed) {
+        this->universe.clear();
+    }
+
+    this->stale = true;
+}
+
+/*************************************************************************************************/
+GameOfLifelet* JrLab::make_game_of_lifelet(const std::string& engine, const LifeRule& rule, int row, int col, float gridsize,
+        int jump, LifeTopology topology) {
+    GameOfLifelet* board = nullptr;
+
+    // 超出范围的步长没有意义, 2^jump 也会溢出
+    if ((jump < 0) || (jump > hashlife_max_jump)) {
+        jump = 0;
+    }
+
+    // 含 B0 的规则和首尾相接的边界在无界宇宙里都没有意义, 交给有边界的位压缩引擎
+    if (rule.states > 2) {
+        // rule 引擎走标量的参照实现, 好和向量化的版本交叉验证
+        if (engine == "rule") {
+            board = new RuleLifelet(row, col, gridsize, rule);
+        } else {
+            board = new GenerationsLifelet(row, col, gridsize, rule);
+        }
+    } else if ((engine == "hashlife") && ((rule.birth & 1U) == 0U) && (topology == LifeTopology::Dead)) {
+        board = new HashLifelet(row, col, gridsize, jump, rule);
+    } else if ((engine == "bitwise") || (engine == "hashlife")) {
+        board = new BitwiseLifelet(row, col, gridsize, rule);
+    } else if (engine == "rule") {
+        board = new RuleLifelet(row, col, gridsize, rule);
+    } else if (rule == conway_rule) {
+        board = new ConwayLifelet(row, col, gridsize);
+    } else if (rule == highlife_rule) {
+        board = new HighLifelet(row, col, gridsize);
+    } else if (rule == seeds_rule) {
+        board = new SeedsLifelet(row, col, gridsize);
+    } else if (rule == day_and_night_rule) {
+        board = new DayAndNightLifelet(row, col, gridsize);
+    } else {
+        board = new RuleLifelet(row, col, gridsize, rule);
+    }
+
+    board->set_topology(topology);
+
+    return board;
 }
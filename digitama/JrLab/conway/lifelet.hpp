@@ -2,14 +2,41 @@
 
 #include <plteen/bang.hpp>
 
+#include "rule.hpp"
+#include "bitboard.hpp"
+#include "byteboard.hpp"
+#include "hashlife.hpp"
+#include "rle.hpp"
+#include "density.hpp"
+#include "history.hpp"
+#include "instrument.hpp"
+
+#include "../parallel/workpool.hpp"
+#include "../parallel/triplebuffer.hpp"
+#include "../random/stream.hpp"
+
 #include <map>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <functional>
 
 namespace JrLab {
+    // 后台演化时交给绘制线程的一代棋盘, 只保存每行存活细胞的连续区间
+    struct LifeSnapshot {
+        std::vector<std::vector<int>> spans;
+        std::vector<std::vector<uint8_t>> states;   // 多态规则里每个区间的状态, 两态规则留空
+        std::vector<uint64_t> versions;     // 每行区间最后一次变化时的版本号
+        uint64_t version = 0U;              // 快照已经包含了截至这个版本的所有变化
+        long long generation = 0;
+        int period = 0;
+    };
+
     /** 声明游戏物体 **/
     class GameOfLifelet : public Plteen::IGraphlet {
     public:
         GameOfLifelet(int n, float gridsize) : GameOfLifelet(n, n, gridsize) {}
-        GameOfLifelet(int row, int col, float gridsize) : row(row), col(col), gridsize(gridsize) {}
+        GameOfLifelet(int row, int col, float gridsize) : row(row), col(col), gridsize(gridsize), scale(gridsize) {}
         virtual ~GameOfLifelet();
 
         void construct(Plteen::dc_t* dc) override;
@@ -21,8 +48,41 @@ namespace JrLab {
     public:
         void show_grid(bool yes);
         void set_color(uint32_t hex);
+        void set_thread_count(int n);
+        void set_cycle_detection(bool yes);
+        void set_topology(JrLab::LifeTopology topology);
+        JrLab::LifeTopology get_topology() { return this->topology; }
         void toggle_life_at_location(float x, float y);
-        int get_generation() { return this->generation; }
+        long long get_generation() { return this->simulating ? this->snapshots.front().generation : this->generation; }
+        int get_period() { return this->simulating ? this->snapshots.front().period : this->period; }   // 已确认的循环周期, 0 表示还没有进入循环
+        long long get_population();
+        int get_row() { return this->row; }
+        int get_col() { return this->col; }
+
+    public: // 视口, 棋盘可以远大于窗口, 只绘制视口里的部分; 缩得太小时改画密度金字塔
+        void set_viewport(float width, float height);
+        void pan(float dx, float dy);
+        void zoom(float factor);
+        void reset_view();
+        float get_scale() { return this->scale; }
+
+    public: // 后台演化, 工作线程全速演化到第 target 代(负数表示直到停止、停滞或进入循环), 绘制只读最近发布的快照
+            // 开始时已经确认了循环的话就不再因为这个循环停下, 要停只能等停滞、循环被打破之后再次确认, 或者手动停止
+        void start_simulation(long long target = -1);
+        void stop_simulation();     // 编辑、保存和单步之前都会先停下工作线程; 子类比基类先析构, 删除棋盘之前也要先停下
+        bool sync_simulation();     // 界面线程定期调用, 取来最新的快照, 返回工作线程是否还在演化
+        bool is_simulating() { return this->simulating; }
+
+    public: // 编辑历史, 切换细胞和演化都只记增量, 撤销演化时从最近的关键帧重放; 预算为 0(默认)表示不记录
+            // 关键帧只拍棋盘本身, 棋盘之外还有世界的引擎(hashlife)不记录历史, 撤销和回退都无事可做
+        void set_history_budget(size_t bytes);
+        bool undo();
+        bool redo();
+        bool rewind(long long generation);     // 退回(或者沿着可以重做的历史前进)到第 generation 代
+
+    public: // 性能记录, 每代的演化、同步和绘制时间以及人口、出生和死亡数, 只保留最近 generations 代; 0(默认)表示不记录
+        void set_instrument_capacity(size_t generations);
+        const JrLab::LifeInstrument& get_instrument() { return this->instrument; }
 
     public:
         void construct_random_world();
@@ -30,18 +90,134 @@ namespace JrLab {
         void reset();
 
     public:
-        void load(const std::string& life_world, std::ifstream& golin);
-        void save(const std::string& life_world, std::ofstream& golout);
+        void load(const std::string& life_world, std::istream& golin);
+        void save(const std::string& life_world, std::ostream& golout);
+        void load_rle(const std::string& life_world, std::istream& golin);
+        void save_rle(const std::string& life_world, std::ostream& golout);
+
+    public:
+        virtual const JrLab::LifeRule& get_rule() { return JrLab::conway_rule; }
+        virtual size_t get_memory_footprint();  // 棋盘及演化引擎占用的字节数(估算)
+
+    protected: // 演化策略, 默认留给子类实现, 只需把 [r0, rn) 行 [c0, cn) 列的下一代写进 shadow, 标记变过的行, 返回是否有变化
+        virtual bool evolve(int** world, int** shadow, int row, int col, int r0, int rn, int c0, int cn) = 0;
+
+    protected: // 存储策略, 默认直接在 world 矩阵上演化(四周带一圈光环), 演化完和 shadow 交换行指针, 返回前进的代数(没有变化则为 0)
+        virtual long long pace_world(int** world, int** shadow, int row, int col);
+        virtual void on_world_edited(bool renewed) {}
+        virtual bool is_board_whole_world() { return true; }    // 棋盘之外还有世界时, 棋盘的哈希和快照都代表不了整个世界
+
+    protected: // 变化清单, 演化和编辑时标记改动过的行, 之后只有这些行需要重新计算哈希和重新扫描绘制
+        uint8_t* row_dirty_flags() { return this->dirty_rows.data(); }
+
+    protected: // 把 count 行(或块行)切成若干带, 有线程池时并行处理, 返回是否有任何一带报告了变化
+        bool foreach_band(int count, const std::function<bool(int, int)>& band_task, int min_band_size = 8);
+
+    private:
+        void draw_cells(Plteen::dc_t* dc, float x, float y, int r0, int rn, int c0, int cn);
+        void draw_density(Plteen::dc_t* dc, float x, float y, int r0, int rn, int c0, int cn);
+        void clamp_view();
+
+    private:
+        bool step();
+        void simulate(long long target);
+        void publish_snapshot();
+
+    private:
+        void set_cell(int r, int c, int state);
+        void write_history_toggles(const JrLab::LifeHistoryEvent& event, bool reverting);
+        void apply_history_toggles(const JrLab::LifeHistoryEvent& event, bool reverting);
+        void replay_history(size_t position);
+
+    private:
+        void mark_all_rows_dirty();
+        void absorb_changes();
+        void rescan_row(int r);
 
-    protected: // 演化策略, 默认留给子类实现
-        virtual void evolve(int** world, int* shadow, int row, int col) = 0;
+    private: // 出生和死亡数, 每行存一份上次吸收变化时的存活位图, 和新的一行比一比就知道谁生谁死
+        void retally();
+        void tally_row(int r);
+
+    private: // 循环检测, 用最近若干代的棋盘哈希找出周期
+        void track_cycle();
+        void forget_history();
+
+    private: // 活跃区块, 只有自己或邻居在上一代发生过变化的区块才需要演化
+        void activate_tiles(bool yes);
+        void activate_tiles_around(int r, int c);
+        void update_active_tiles();
+        bool is_border_tile(int tr, int tc);
+        void activate_border_tiles();
+
+    private: // 边界拓扑, 演化之前把光环按拓扑填好, 内层循环就不用判断边界了
+        void refresh_halo();
 
     private:
         int row;
         int col;
-        int generation;
+        long long generation;
         int** world = nullptr;
-        int* shadow = nullptr;
+        int** shadow = nullptr;
+        int* cells = nullptr;   // world 和 shadow 共用的一整块内存
+        int stride = 0;         // 每行占的 int 数, 包括光环和对齐的部分
+        JrLab::RandomStream random { "game of life" };
+        std::vector<uint64_t> random_bits;  // 随机棋盘每行用到的随机位
+
+    private:
+        std::vector<uint8_t> dirty_rows;
+        std::vector<uint8_t> repaint_rows;
+        std::vector<std::vector<int>> live_spans;   // 每行存活细胞的连续区间 [c0, cn), 多态规则里同一区间的状态也相同
+        std::vector<std::vector<uint8_t>> span_states;
+        std::vector<uint64_t> span_versions;        // 每行区间最后一次重新扫描时的版本号
+        uint64_t span_version = 0U;
+
+    private:
+        std::vector<uint64_t> row_hashes;
+        std::vector<uint64_t> history_hashes;
+        std::vector<long long> history_generations;
+        uint64_t world_hash = 0U;
+        int history_head = 0;
+        int history_count = 0;
+        int candidate_period = 0;
+        int period_streak = 0;
+        int period = 0;
+        bool cycle_detection = false;
+
+    private:
+        std::vector<uint8_t> active_tiles;
+        std::vector<uint8_t> changed_tiles;
+        int tile_rows;
+        int tile_cols;
+
+    private:
+        JrLab::LifeTopology topology = JrLab::LifeTopology::Dead;
+
+    private:
+        JrLab::LifeDensityPyramid density;
+
+    private:
+        JrLab::LifeHistory history;
+        bool replaying = false;
+
+    private:
+        JrLab::LifeInstrument instrument;
+        std::vector<uint64_t> alive_bits;
+        std::vector<int> row_births;
+        std::vector<int> row_deaths;
+        int alive_words = 0;        // 每行位图的字数
+        long long population = 0;
+        long long births = 0;       // 上次演化之后累计的出生和死亡
+        long long deaths = 0;
+
+    private:
+        JrLab::WorkPool* workers = nullptr;
+
+    private: // 后台演化的线程和快照, simulating 只由界面线程读写
+        JrLab::TripleBuffer<JrLab::LifeSnapshot> snapshots;
+        std::thread simulator;
+        std::atomic<bool> simulation_stopping { false };
+        std::atomic<bool> simulation_done { false };
+        bool simulating = false;
 
     private:
         uint32_t color = BLACK;
@@ -49,20 +225,128 @@ namespace JrLab {
 
     private:
         float gridsize;
+        float scale;                // 当前每个细胞的像素边长, 可以小于 1
+        float view_width = 0.0F;    // 视口大小, 为 0 表示显示整个棋盘
+        float view_height = 0.0F;
+        int view_x = 0;             // 视口左上角的细胞坐标
+        int view_y = 0;
     };
 
     /*********************************************************************************************/
-    class ConwayLifelet : public JrLab::GameOfLifelet {
-        using GameOfLifelet::GameOfLifelet;
+    // 任意 B/S 规则串描述的外总和型规则, 运行时按掩码查下一代
+    class RuleLifelet : public JrLab::GameOfLifelet {
+    public:
+        RuleLifelet(int n, float gridsize, const JrLab::LifeRule& rule) : RuleLifelet(n, n, gridsize, rule) {}
+        RuleLifelet(int row, int col, float gridsize, const JrLab::LifeRule& rule)
+            : GameOfLifelet(row, col, gridsize), rule(rule) {}
+
+    public:
+        const JrLab::LifeRule& get_rule() override { return this->rule; }
 
     protected:
-        void evolve(int** world, int* shadow, int row, int col) override;
+        bool evolve(int** world, int** shadow, int row, int col, int r0, int rn, int c0, int cn) override;
+
+    private:
+        JrLab::LifeRule rule;
     };
 
-    class HighLifelet : public JrLab::GameOfLifelet {
-        using GameOfLifelet::GameOfLifelet;
+    // 常用规则在编译期实例化, 内层循环里的诞生/存活条件都是常量
+    template<uint16_t Birth, uint16_t Survival>
+    class StaticRuleLifelet : public JrLab::RuleLifelet {
+    public:
+        StaticRuleLifelet(int n, float gridsize) : StaticRuleLifelet(n, n, gridsize) {}
+        StaticRuleLifelet(int row, int col, float gridsize)
+            : RuleLifelet(row, col, gridsize, JrLab::LifeRule { Birth, Survival }) {}
 
     protected:
-        void evolve(int** world, int* shadow, int row, int col) override;
+        bool evolve(int** world, int** shadow, int row, int col, int r0, int rn, int c0, int cn) override;
+    };
+
+    extern template class StaticRuleLifelet<JrLab::conway_rule.birth, JrLab::conway_rule.survival>;
+    extern template class StaticRuleLifelet<JrLab::highlife_rule.birth, JrLab::highlife_rule.survival>;
+    extern template class StaticRuleLifelet<JrLab::seeds_rule.birth, JrLab::seeds_rule.survival>;
+    extern template class StaticRuleLifelet<JrLab::day_and_night_rule.birth, JrLab::day_and_night_rule.survival>;
+
+    class ConwayLifelet : public JrLab::StaticRuleLifelet<JrLab::conway_rule.birth, JrLab::conway_rule.survival> {
+        using StaticRuleLifelet::StaticRuleLifelet;
+    };
+
+    class HighLifelet : public JrLab::StaticRuleLifelet<JrLab::highlife_rule.birth, JrLab::highlife_rule.survival> {
+        using StaticRuleLifelet::StaticRuleLifelet;
+    };
+
+    class SeedsLifelet : public JrLab::StaticRuleLifelet<JrLab::seeds_rule.birth, JrLab::seeds_rule.survival> {
+        using StaticRuleLifelet::StaticRuleLifelet;
     };
+
+    class DayAndNightLifelet : public JrLab::StaticRuleLifelet<JrLab::day_and_night_rule.birth, JrLab::day_and_night_rule.survival> {
+        using StaticRuleLifelet::StaticRuleLifelet;
+    };
+
+    /*********************************************************************************************/
+    // 位压缩布局, 演化结果与同一规则的 RuleLifelet 完全一致, world 矩阵只作为绘制和编辑的镜像
+    class BitwiseLifelet : public JrLab::RuleLifelet {
+    public:
+        BitwiseLifelet(int row, int col, float gridsize, const JrLab::LifeRule& rule = JrLab::conway_rule)
+            : RuleLifelet(row, col, gridsize, rule) { this->bits.set_rule(rule); }
+
+    protected:
+        long long pace_world(int** world, int** shadow, int row, int col) override;
+        void on_world_edited(bool renewed) override { this->stale = true; }
+
+    public:
+        size_t get_memory_footprint() override { return RuleLifelet::get_memory_footprint() + this->bits.memory_footprint(); }
+
+    private:
+        JrLab::LifeBitBoard bits;
+        bool stale = true;
+    };
+
+    // Generations 规则, 一个字节一个细胞, 用向量指令演化; world 矩阵里存的是细胞的状态, 衰老中的细胞按状态画成渐暗的颜色
+    class GenerationsLifelet : public JrLab::RuleLifelet {
+    public:
+        GenerationsLifelet(int row, int col, float gridsize, const JrLab::LifeRule& rule = JrLab::brians_brain_rule)
+            : RuleLifelet(row, col, gridsize, rule) { this->bytes.set_rule(rule); }
+
+    protected:
+        long long pace_world(int** world, int** shadow, int row, int col) override;
+        void on_world_edited(bool renewed) override { this->stale = true; }
+
+    public:
+        size_t get_memory_footprint() override { return RuleLifelet::get_memory_footprint() + this->bytes.memory_footprint(); }
+
+    private:
+        JrLab::LifeByteBoard bytes;
+        bool stale = true;
+    };
+
+    // HashLife 无界宇宙, 棋盘只是观察宇宙的视口, 每一步演化 2^jump 代; 不支持含 B0 的规则, 也不受边界拓扑的影响
+    class HashLifelet : public JrLab::RuleLifelet {
+    public:
+        HashLifelet(int row, int col, float gridsize, int jump = 0, const JrLab::LifeRule& rule = JrLab::conway_rule)
+            : RuleLifelet(row, col, gridsize, rule), jump(jump) { this->universe.set_rule(rule); }
+
+    protected:
+        long long pace_world(int** world, int** shadow, int row, int col) override;
+        void on_world_edited(bool renewed) override;
+        bool is_board_whole_world() override { return false; }
+
+    public:
+        size_t get_memory_footprint() override { return RuleLifelet::get_memory_footprint() + this->universe.memory_footprint(); }
+
+    private:
+        JrLab::HashLifeUniverse universe;
+        int jump;
+        bool stale = true;
+    };
+
+    /*********************************************************************************************/
+    /**
+     * 按引擎名(bitwise, hashlife, rule, 留空则为 int 矩阵)和规则创建棋盘
+     * int 矩阵对常用规则使用编译期特化的版本, rule 则总是查运行时的掩码;
+     * 含 B0 的规则和首尾相接的边界不能交给 hashlife, 改用 bitwise;
+     * Generations 规则除了 rule 引擎走标量的 RuleLifelet 之外, 总是交给 GenerationsLifelet
+     */
+    JrLab::GameOfLifelet* make_game_of_lifelet(const std::string& engine, const JrLab::LifeRule& rule,
+        int row, int col, float gridsize, int jump = 0, JrLab::LifeTopology topology = JrLab::LifeTopology::Dead);
 }
@@ -0,0 +1,263 @@
+#include "rle.hpp"
+
+#include <cctype>
+#include <cstdlib>
+#include <vector>
+
+using namespace JrLab;
+
+/*************************************************************************************************/
+static const std::streamsize rle_chunk_size = 1 << 16;
+static const int rle_line_width = 70;    // 标准 RLE 每行不超过 70 个字符
+static const int rle_state_letters = 24; // 多状态 RLE 每个前缀下有 A-X 共 24 个状态
+
+static inline std::string trim(const std::string& s) {
+    size_t start = s.find_first_not_of(" \t\r\n");
+    size_t end = s.find_last_not_of(" \t\r\n");
+
+    return (start == std::string::npos) ? std::string() : s.substr(start, end - start + 1);
+}
+
+namespace {
+    class RLEBuffer {
+    public:
+        RLEBuffer(std::ostream& rleout) : rleout(rleout), buffer(rle_chunk_size + rle_line_width + 1) {}
+
+    public:
+        void line(const std::string& text) {
+            this->rleout.write(this->buffer.data(), this->used);
+            this->rleout.write(text.data(), std::streamsize(text.size()));
+            this->rleout.put('\n');
+            this->used = 0;
+            this->width = 0;
+        }
+
+        void token(int count, char tag, char prefix = '\0') {
+            char tok[16];
+            int len = 0;
+
+            // 倒着填数字, 比 snprintf 快得多
+            if (count > 1) {
+                char digits[12];
+                int n = 0;
+
+                while (count > 0) {
+                    digits[n ++] = char('0' + count % 10);
+                    count /= 10;
+                }
+
+                while (n > 0) {
+                    tok[len ++] = digits[-- n];
+                }
+            }
+
+            if (prefix != '\0') {
+                tok[len ++] = prefix;
+            }
+
+            tok[len ++] = tag;
+
+            // 标记不能拆到两行
+            if (this->width + len > rle_line_width) {
+                this->buffer[size_t(this->used ++)] = '\n';
+                this->width = 0;
+            }
+
+            for (int idx = 0; idx < len; idx ++) {
+                this->buffer[size_t(this->used ++)] = tok[idx];
+            }
+
+            this->width += len;
+
+            if (this->used >= rle_chunk_size) {
+                this->flush();
+            }
+        }
+
+        void flush() {
+            if (this->used > 0) {
+                this->rleout.write(this->buffer.data(), this->used);
+                this->used = 0;
+            }
+        }
+
+    private:
+        std::ostream& rleout;
+        std::vector<char> buffer;
+        std::streamsize used = 0;
+        int width = 0;
+    };
+}
+
+/*************************************************************************************************/
+bool JrLab::is_life_rle(const std::string& path, std::istream& golin) {
+    size_t dot = path.find_last_of('.');
+    bool yes = false;
+
+    if (dot != std::string::npos) {
+        std::string ext = path.substr(dot);
+
+        for (auto& ch : ext) {
+            ch = char(tolower(ch));
+        }
+
+        yes = (ext == ".rle");
+    }
+
+    // .gof 只有 0 和 1, RLE 以注释或头部开头
+    if (!yes) {
+        int ch = golin.peek();
+
+        yes = ((ch == '#') || (ch == 'x'));
+    }
+
+    return yes;
+}
+
+void JrLab::read_life_rle_header(std::istream& rlein, LifeRLEHeader* header) {
+    std::string line;
+    bool done = false;
+
+    while (!done) {
+        int ch = rlein.peek();
+
+        if (ch == '#') {
+            std::getline(rlein, line);
+        } else if ((ch == ' ') || (ch == '\t') || (ch == '\r') || (ch == '\n')) {
+            rlein.get();
+        } else {
+            if (ch == 'x') {
+                size_t start = 0;
+
+                std::getline(rlein, line);
+
+                // x = 3, y = 3, rule = B3/S23
+                while (start < line.size()) {
+                    size_t comma = line.find(',', start);
+                    std::string field = line.substr(start, (comma == std::string::npos) ? std::string::npos : comma - start);
+                    size_t eq = field.find('=');
+
+                    if (eq != std::string::npos) {
+                        std::string key = trim(field.substr(0, eq));
+                        std::string value = trim(field.substr(eq + 1));
+
+                        if (key == "x") {
+                            header->width = std::atoi(value.c_str());
+                        } else if (key == "y") {
+                            header->height = std::atoi(value.c_str());
+                        } else if (key == "rule") {
+                            header->rule = value;
+                        }
+                    }
+
+                    start = (comma == std::string::npos) ? line.size() : comma + 1;
+                }
+            }
+
+            done = true;
+        }
+    }
+}
+
+void JrLab::read_life_rle_body(std::istream& rlein, const std::function<void(int, int, int, int)>& on_span) {
+    std::streambuf* src = rlein.rdbuf();
+    std::vector<char> chunk(rle_chunk_size);
+    int r = 0;
+    int c = 0;
+    int count = 0;
+    int prefix = 0;
+    bool done = false;
+
+    // 直接从流缓冲区成块读取, 不受流的异常设置影响, 读到文件末尾也不会抛异常
+    while (!done) {
+        std::streamsize n = src->sgetn(chunk.data(), rle_chunk_size);
+
+        if (n <= 0) {
+            break;
+        }
+
+        for (std::streamsize idx = 0; (idx < n) && !done; idx ++) {
+            char ch = chunk[size_t(idx)];
+
+            if ((ch >= '0') && (ch <= '9')) {
+                count = count * 10 + (ch - '0');
+            } else if ((ch == ' ') || (ch == '\t') || (ch == '\r') || (ch == '\n')) {
+                /* 空白不影响计数 */
+            } else if ((ch >= 'p') && (ch <= 'y')) {
+                prefix = (ch - 'p' + 1) * rle_state_letters; // 多状态规则的前缀, 等下一个字母一起处理
+            } else {
+                int run = (count == 0) ? 1 : count;
+
+                if ((ch == 'b') || (ch == '.')) {
+                    c += run;
+                } else if (ch == '$') {
+                    r += run;
+                    c = 0;
+                } else if (ch == '!') {
+                    done = true;
+                } else if ((ch >= 'A') && (ch <= 'X')) {   // 多状态规则: A 是活细胞, B 以后是衰老状态
+                    on_span(r, c, c + run, prefix + (ch - 'A') + 1);
+                    c += run;
+                } else if (isalpha(ch)) {   // o 以及其他不认识的字母都当作活细胞
+                    on_span(r, c, c + run, 1);
+                    c += run;
+                }
+
+                count = 0;
+                prefix = 0;
+            }
+        }
+    }
+}
+
+void JrLab::write_life_rle(std::ostream& rleout, int** world, int row, int col, const std::string& rule, int states) {
+    RLEBuffer buffer(rleout);
+    int pending_rows = 0;
+
+    buffer.line("x = " + std::to_string(col) + ", y = " + std::to_string(row) + ", rule = " + rule);
+
+    for (int r = 0; r < row; r ++) {
+        int dead = 0;
+        int c = 0;
+
+        while (c < col) {
+            int state = world[r][c];
+            int c0 = c;
+
+            // 两态规则只分死活, 多态规则每个状态各成一段
+            while ((c < col) && ((states > 2) ? (world[r][c] == state) : ((world[r][c] > 0) == (state > 0)))) {
+                c ++;
+            }
+
+            if (state > 0) {
+                if (pending_rows > 0) {
+                    buffer.token(pending_rows, '$');
+                    pending_rows = 0;
+                }
+
+                if (dead > 0) {
+                    buffer.token(dead, (states > 2) ? '.' : 'b');
+                    dead = 0;
+                }
+
+                if (states > 2) {
+                    int letter = (state - 1) % rle_state_letters;
+                    int page = (state - 1) / rle_state_letters;
+
+                    buffer.token(c - c0, char('A' + letter), (page > 0) ? char('p' + page - 1) : '\0');
+                } else {
+                    buffer.token(c - c0, 'o');
+                }
+            } else {
+                dead += c - c0;
+            }
+        }
+
+        // 行尾的死细胞直接省略
+        pending_rows ++;
+    }
+
+    buffer.token(1, '!');
+    buffer.line("");
+    buffer.flush();
+}
@@ -0,0 +1,34 @@
+#pragma once // 确保只被 include 一次
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <functional>
+
+namespace JrLab {
+    /**
+     * 标准 Life RLE 格式
+     *   #C 注释
+     *   x = 3, y = 3, rule = B3/S23
+     *   bo$2bo$3o!
+     * b 是死细胞, o 是活细胞, $ 换行, ! 结束, 前面的数字是重复次数
+     * 多状态规则(Generations)用 . 表示死细胞, A 表示活细胞, B 以后是衰老状态, 超过 X 的状态加 p-y 前缀
+     */
+    struct LifeRLEHeader {
+        int width = 0;
+        int height = 0;
+        std::string rule;
+    };
+
+    // 跳过注释并读取 "x = ..." 头部, 没有头部时 header 保持原样
+    void read_life_rle_header(std::istream& rlein, JrLab::LifeRLEHeader* header);
+
+    // 流式解析图案主体, 每遇到一段同状态的非死细胞就回调一次 on_span(r, c0, cn, state), 即第 r 行 [c0, cn) 列
+    void read_life_rle_body(std::istream& rlein, const std::function<void(int, int, int, int)>& on_span);
+
+    // 按行写出整个棋盘, 每行末尾的死细胞和连续的空行都会被压缩掉, states 大于 2 时按多状态格式写出
+    void write_life_rle(std::ostream& rleout, int** world, int row, int col, const std::string& rule, int states = 2);
+
+    // 根据扩展名或文件开头判断是否为 RLE 格式
+    bool is_life_rle(const std::string& path, std::istream& golin);
+}
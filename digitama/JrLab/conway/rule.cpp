@@ -0,0 +1,199 @@
+#include "rule.hpp"
+
+#include <cctype>
+
+using namespace JrLab;
+
+/*************************************************************************************************/
+struct NamedLifeRule {
+    const char* name;
+    LifeRule rule;
+};
+
+static const NamedLifeRule named_rules[] = {
+    { "conway", conway_rule },
+    { "life", conway_rule },
+    { "highlife", highlife_rule },
+    { "legacyhighlife", legacy_highlife_rule },
+    { "seeds", seeds_rule },
+    { "daynight", day_and_night_rule },
+    { "lwod", life_without_death_rule },
+    { "maze", maze_rule },
+    { "brain", brians_brain_rule },
+    { "briansbrain", brians_brain_rule },
+    { "starwars", star_wars_rule }
+};
+
+struct NamedLifeTopology {
+    const char* name;
+    LifeTopology topology;
+};
+
+static const NamedLifeTopology named_topologies[] = {
+    { "dead", LifeTopology::Dead },
+    { "plane", LifeTopology::Dead },
+    { "torus", LifeTopology::Torus },
+    { "klein", LifeTopology::Klein }
+};
+
+static inline bool append_neighbor_count(char ch, uint16_t* mask) {
+    bool okay = false;
+
+    if ((ch >= '0') && (ch <= '8')) {
+        (*mask) |= uint16_t(1U << (ch - '0'));
+        okay = true;
+    }
+
+    return okay;
+}
+
+// 状态数是一个普通的十进制数, 2 就是普通的两态规则
+static inline bool parse_state_count(const std::string& digits, uint8_t* states) {
+    int n = 0;
+    bool okay = (!digits.empty()) && (digits.size() <= 3);
+
+    for (size_t idx = 0; okay && (idx < digits.size()); idx ++) {
+        okay = (digits[idx] >= '0') && (digits[idx] <= '9');
+        n = n * 10 + (digits[idx] - '0');
+    }
+
+    okay = okay && (n >= 2) && (n <= 255);
+
+    if (okay) {
+        (*states) = uint8_t(n);
+    }
+
+    return okay;
+}
+
+/*************************************************************************************************/
+bool JrLab::parse_life_rule(const std::string& rulestring, LifeRule* rule) {
+    std::string rs;
+    uint16_t birth = 0U;
+    uint16_t survival = 0U;
+    uint8_t states = 2U;
+    bool okay = true;
+
+    for (char ch : rulestring) {
+        if (!isspace(ch)) {
+            rs.push_back(char(tolower(ch)));
+        }
+    }
+
+    if (rs.empty()) {
+        return false;
+    }
+
+    for (auto& named : named_rules) {
+        if (rs == named.name) {
+            (*rule) = named.rule;
+            return true;
+        }
+    }
+
+    if ((rs.find('b') != std::string::npos) || (rs.find('s') != std::string::npos)) {
+        size_t generations = rs.find_first_of("cg");
+        uint16_t* target = nullptr;
+
+        // B2/S345/C4, b2s345g4: 状态数总在最后
+        if (generations != std::string::npos) {
+            okay = parse_state_count(rs.substr(generations + 1), &states);
+            rs.erase(generations);
+        }
+
+        // B3/S23, S23/B3, b3s23
+        for (size_t idx = 0; okay && (idx < rs.size()); idx ++) {
+            char ch = rs[idx];
+
+            if (ch == 'b') {
+                target = &birth;
+            } else if (ch == 's') {
+                target = &survival;
+            } else if (ch == '/') {
+                target = nullptr;
+            } else {
+                okay = (target != nullptr) && append_neighbor_count(ch, target);
+            }
+        }
+    } else {
+        size_t slash = rs.find('/');
+        size_t generations = rs.find('/', slash + 1);
+
+        // 传统写法 23/3: 斜杠前面是存活条件, 后面是诞生条件; 345/2/4 的第三段是状态数
+        okay = (slash != std::string::npos);
+
+        if (okay && (generations != std::string::npos)) {
+            okay = parse_state_count(rs.substr(generations + 1), &states);
+            rs.erase(generations);
+        }
+
+        for (size_t idx = 0; okay && (idx < rs.size()); idx ++) {
+            if (idx != slash) {
+                okay = append_neighbor_count(rs[idx], (idx < slash) ? &survival : &birth);
+            }
+        }
+    }
+
+    if (okay) {
+        rule->birth = birth;
+        rule->survival = survival;
+        rule->states = states;
+    }
+
+    return okay;
+}
+
+std::string JrLab::life_rule_to_string(const LifeRule& rule) {
+    std::string rs = "B";
+
+    for (int n = 0; n <= 8; n ++) {
+        if ((rule.birth >> n) & 1U) {
+            rs.push_back(char('0' + n));
+        }
+    }
+
+    rs.append("/S");
+
+    for (int n = 0; n <= 8; n ++) {
+        if ((rule.survival >> n) & 1U) {
+            rs.push_back(char('0' + n));
+        }
+    }
+
+    if (rule.states > 2) {
+        rs.append("/C").append(std::to_string(rule.states));
+    }
+
+    return rs;
+}
+
+/*************************************************************************************************/
+bool JrLab::parse_life_topology(const std::string& name, LifeTopology* topology) {
+    std::string tn;
+
+    for (char ch : name) {
+        tn.push_back(char(tolower(ch)));
+    }
+
+    for (auto& named : named_topologies) {
+        if (tn == named.name) {
+            (*topology) = named.topology;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+const char* JrLab::life_topology_name(LifeTopology topology) {
+    const char* name = "dead";
+
+    for (auto& named : named_topologies) {
+        if (named.topology == topology) {
+            name = named.name;
+            break;
+        }
+    }
+
+    return name;
+}
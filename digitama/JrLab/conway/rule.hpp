@@ -0,0 +1,84 @@
+#pragma once // 确保只被 include 一次
+
+#include <cstdint>
+#include <string>
+
+namespace JrLab {
+    /**
+     * 外总和型(Life-like)规则, 即 B/S 规则串
+     * birth 的第 n 位表示死细胞有 n 个活邻居时诞生, survival 的第 n 位表示活细胞有 n 个活邻居时存活;
+     * states 大于 2 时是 Generations 规则: 不能存活的活细胞(状态 1)不会马上死去,
+     * 而是逐代衰老成 2, 3, ..., states - 1 再变回 0, 衰老中的细胞不算活邻居, 也不会诞生;
+     * next_state 只管两态的规则, next_generations_state 是多态规则的标量版本, 向量化的 GenerationsLifelet 以它为准
+     */
+    struct LifeRule {
+        uint16_t birth;
+        uint16_t survival;
+        uint8_t states = 2;
+
+        constexpr int next_state(int self, int n) const {
+            return int((((self > 0) ? this->survival : this->birth) >> n) & 1U);
+        }
+
+        constexpr int next_generations_state(int self, int n) const {   // n 只数状态为 1 的邻居
+            return (self == 0) ? int((this->birth >> n) & 1U)
+                : (((self == 1) && (((this->survival >> n) & 1U) != 0U)) ? 1 : ((self + 1 < this->states) ? self + 1 : 0));
+        }
+
+        constexpr bool operator==(const LifeRule& other) const {
+            return (this->birth == other.birth) && (this->survival == other.survival) && (this->states == other.states);
+        }
+
+        constexpr bool operator!=(const LifeRule& other) const {
+            return !(*this == other);
+        }
+    };
+
+    // 把 "36" 这样的数字串转换成邻居数掩码
+    constexpr uint16_t life_neighbor_mask(const char* digits) {
+        uint16_t mask = 0U;
+
+        for (int idx = 0; digits[idx] != '\0'; idx ++) {
+            mask |= uint16_t(1U << (digits[idx] - '0'));
+        }
+
+        return mask;
+    }
+
+    constexpr LifeRule make_life_rule(const char* birth, const char* survival) {
+        return { life_neighbor_mask(birth), life_neighbor_mask(survival) };
+    }
+
+    constexpr LifeRule make_generations_rule(const char* birth, const char* survival, uint8_t states) {
+        return { life_neighbor_mask(birth), life_neighbor_mask(survival), states };
+    }
+
+    /** 常用规则 **/
+    constexpr LifeRule conway_rule = make_life_rule("3", "23");
+    constexpr LifeRule highlife_rule = make_life_rule("36", "23");
+    constexpr LifeRule legacy_highlife_rule = make_life_rule("36", "236");  // 旧版 HighLifelet 的实际规则, 6 个邻居的活细胞也能存活, 用来重放旧演示
+    constexpr LifeRule seeds_rule = make_life_rule("2", "");
+    constexpr LifeRule day_and_night_rule = make_life_rule("3678", "34678");
+    constexpr LifeRule life_without_death_rule = make_life_rule("3", "012345678");
+    constexpr LifeRule maze_rule = make_life_rule("3", "12345");
+    constexpr LifeRule brians_brain_rule = make_generations_rule("2", "", 3);
+    constexpr LifeRule star_wars_rule = make_generations_rule("2", "345", 4);
+
+    /**
+     * 解析规则串, 支持 "B36/S23", "b36s23", 传统的 "23/36"(先 S 后 B), 以及常用规则的名字;
+     * Generations 规则在后面加上状态数, 如 "B2/S345/C4", "b2s345g4", 或者传统的 "345/2/4";
+     * 解析失败时返回 false, rule 保持原样
+     */
+    bool parse_life_rule(const std::string& rulestring, JrLab::LifeRule* rule);
+    std::string life_rule_to_string(const JrLab::LifeRule& rule);
+
+    /**
+     * 有界棋盘的边界拓扑
+     * Dead: 边界之外都是死细胞; Torus: 上下、左右各自相接;
+     * Klein: 左右直接相接, 上下翻转之后相接(克莱因瓶)
+     */
+    enum class LifeTopology { Dead, Torus, Klein };
+
+    bool parse_life_topology(const std::string& name, JrLab::LifeTopology* topology);
+    const char* life_topology_name(JrLab::LifeTopology topology);
+}
@@ -0,0 +1,75 @@
+#include "sparklet.hpp"
+
+using namespace Plteen;
+using namespace JrLab;
+
+/*************************************************************************************************/
+static const float bar_width = 2.0F;
+static const float chart_ratio = 0.65F;     // 柱状图占的高度, 剩下的画人口折线
+static const double background_alpha = 0.64;
+
+/*************************************************************************************************/
+void JrLab::LifeSparklet::draw(Plteen::dc_t* dc, float x, float y, float Width, float Height) {
+    size_t n = size_t(Width / bar_width);
+    float chart_height = Height * chart_ratio;
+    float line_top = y + chart_height;
+    float line_height = Height - chart_height;
+    uint64_t peak_ns = 1U;
+    long long peak_population = 0;
+    long long least_population = 0;
+
+    dc->fill_rect(x, y, Width, Height, RGBA(BLACK, background_alpha));
+    this->board->get_instrument().recent(this->samples, n);
+
+    if (!this->samples.empty()) {
+        least_population = this->samples[0].population;
+        peak_population = this->samples[0].population;
+    }
+
+    for (auto& s : this->samples) {
+        uint64_t total = s.evolve_ns + s.sync_ns + s.draw_ns;
+
+        if (total > peak_ns) {
+            peak_ns = total;
+        }
+
+        if (s.population > peak_population) {
+            peak_population = s.population;
+        } else if (s.population < least_population) {
+            least_population = s.population;
+        }
+    }
+
+    // 最新的一代贴着右边, 从下往上依次是演化、同步、绘制
+    for (size_t i = 0; i < this->samples.size(); i ++) {
+        const LifeGenerationSample& s = this->samples[i];
+        float bx = x + Width - float(this->samples.size() - i) * bar_width;
+        float evolve_height = chart_height * float(s.evolve_ns) / float(peak_ns);
+        float sync_height = chart_height * float(s.sync_ns) / float(peak_ns);
+        float draw_height = chart_height * float(s.draw_ns) / float(peak_ns);
+        float by = y + chart_height - evolve_height;
+
+        dc->fill_rect(bx, by, bar_width, evolve_height, GREEN);
+        dc->fill_rect(bx, by - sync_height, bar_width, sync_height, ORANGE);
+        dc->fill_rect(bx, by - sync_height - draw_height, bar_width, draw_height, ROYALBLUE);
+    }
+
+    for (size_t i = 1; i < this->samples.size(); i ++) {
+        long long range = peak_population - least_population;
+        float x0 = x + Width - float(this->samples.size() - i + 1) * bar_width;
+        float y0 = line_top + line_height;
+        float y1 = line_top + line_height;
+
+        if (range > 0) {
+            y0 -= line_height * float(this->samples[i - 1].population - least_population) / float(range);
+            y1 -= line_height * float(this->samples[i].population - least_population) / float(range);
+        } else {
+            y0 -= line_height * 0.5F;
+            y1 -= line_height * 0.5F;
+        }
+
+        dc->draw_line(x0, y0, x0 + bar_width, y1, GOLD);
+    }
+
+    dc->draw_rect(x, y, Width, Height, DIMGRAY);
+}
@@ -0,0 +1,32 @@
+#pragma once // 确保只被 include 一次
+
+#include <plteen/bang.hpp>
+
+#include "lifelet.hpp"
+
+#include <vector>
+
+namespace JrLab {
+    /**
+     * 生命棋盘性能记录的叠加层
+     * 上面是最近若干代的耗时柱状图, 每代一根柱子, 演化、同步、绘制三段叠起来, 按窗口里最高的一根缩放;
+     * 下面是人口的折线, 按窗口里的最小值和最大值缩放
+     */
+    class LifeSparklet : public Plteen::IGraphlet {
+    public:
+        LifeSparklet(JrLab::GameOfLifelet* board, float width, float height)
+            : board(board), width(width), height(height) {}
+
+    public:
+        Plteen::Box get_bounding_box() override { return { this->width, this->height }; }
+        void draw(Plteen::dc_t* dc, float x, float y, float Width, float Height) override;
+
+    private:
+        JrLab::GameOfLifelet* board;
+        float width;
+        float height;
+
+    private:
+        std::vector<JrLab::LifeGenerationSample> samples;
+    };
+}
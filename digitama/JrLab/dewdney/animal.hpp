@@ -1,15 +1,18 @@
 #pragma once // 确保只被 include 一次
 
 #include <plteen/bang.hpp>
-#include <vector>
 
-namespace JrLab {
-    static const int MOVING_WAYS = 8;
+#include "population.hpp"
 
+namespace JrLab {
     /*********************************************************************************************/
+    /**
+     * 精灵只是 SteppePopulation 里某只动物的视图, 只记住它的编号和精灵当前所在的格子
+     * 动物死了视图就失效, 由世界负责回收精灵
+     */
     class IToroidalMovingAnimal : public Plteen::IMatterMetadata {
     public:
-        IToroidalMovingAnimal(int row, int col, const int gene[MOVING_WAYS], double duration, int cycle, int energy);
+        IToroidalMovingAnimal(const JrLab::SteppePopulation* population, uint64_t id);
         virtual ~IToroidalMovingAnimal() {}
 
         std::string description();
@@ -18,42 +21,22 @@ namespace JrLab {
         void draw(Plteen::dc_t* dc, float x, float y, float width, float height);
 
     public:
-        void turn();
-        void move(int* dr = nullptr, int* dc = nullptr);
-        void eat(int food_energy);
-        IToroidalMovingAnimal* asexually_reproduce();
+        bool sync(int* dr = nullptr, int* dc = nullptr);    // 跟上动物的位置, 返回动物是否还活着
+        void rebind(uint64_t id);                           // 精灵回收之后改绑到同一物种的另一只动物
 
     public:
-        bool is_alive() const { return this->energy > 0; }
-        bool can_reproduce() const { return (this->energy >= this->reproduce_energy) && (this->countdown <= 0); }
+        bool is_alive() const { return this->population->find(this->id) >= 0; }
+        uint64_t creature() const { return this->id; }
+        JrLab::SteppeSpecies current_species() const { return this->species; }
         double pace_duration() { return this->duration; }
-        int current_generation() { return this->generation; }
         int current_row() { return r; }
         int current_col() { return c; }
 
-    public:
-        void on_time_fly(int day);
-
-    private:
-        int angle(int idx0, int rnd);
-
     private:
+        const JrLab::SteppePopulation* population;
+        uint64_t id;
+        JrLab::SteppeSpecies species;
         double duration;
-        int full_energy;
-        int reproduce_energy;
-        int gene[MOVING_WAYS];
-        int breeding_cycle;
-        int row;
-        int col;
-
-    private:
-        int bio_clock;
-        int generation;
-        int countdown;
-    
-    private:
-        int direction;
-        int energy;
         int r;
         int c;
     };
@@ -61,8 +44,7 @@ namespace JrLab {
     /*********************************************************************************************/
     class TMRooster : public Plteen::Rooster {
     public:
-        TMRooster(int row, int col, int cycle = 30, int energy = 300);
-        TMRooster(IToroidalMovingAnimal* self);
+        TMRooster(const JrLab::SteppePopulation* population, uint64_t id);
         virtual ~TMRooster() {}
 
         const char* name() override { return "公鸡"; }
@@ -71,13 +53,12 @@ namespace JrLab {
         void draw(Plteen::dc_t* dc, float x, float y, float width, float height) override;
 
     public:
-        Animal* asexually_reproduce() override;
+        Animal* asexually_reproduce() override { return nullptr; }  // 繁殖由 SteppePopulation 负责
     };
 
     class TMPigeon : public Plteen::Pigeon {
     public:
-        TMPigeon(int row, int col, int cycle = 30, int energy = 300);
-        TMPigeon(IToroidalMovingAnimal* self);
+        TMPigeon(const JrLab::SteppePopulation* population, uint64_t id);
         virtual ~TMPigeon() {}
 
         const char* name() override { return "鸽子"; }
@@ -86,13 +67,12 @@ namespace JrLab {
         void draw(Plteen::dc_t* dc, float x, float y, float width, float height) override;
 
     public:
-        Animal* asexually_reproduce() override;
+        Animal* asexually_reproduce() override { return nullptr; }  // 繁殖由 SteppePopulation 负责
     };
 
     class TMCow : public Plteen::Cow {
     public:
-        TMCow(int row, int col, int cycle = 365, int energy = 600);
-        TMCow(IToroidalMovingAnimal* self);
+        TMCow(const JrLab::SteppePopulation* population, uint64_t id);
         virtual ~TMCow() {}
 
         const char* name() override { return "奶牛"; }
@@ -101,13 +81,12 @@ namespace JrLab {
         void draw(Plteen::dc_t* dc, float x, float y, float width, float height) override;
 
     public:
-        Animal* asexually_reproduce() override;
+        Animal* asexually_reproduce() override { return nullptr; }  // 繁殖由 SteppePopulation 负责
     };
 
     class TMCat : public Plteen::Cat {
     public:
-        TMCat(int row, int col, int cycle = 58, int energy = 1000);
-        TMCat(IToroidalMovingAnimal* self);
+        TMCat(const JrLab::SteppePopulation* population, uint64_t id);
         virtual ~TMCat() {}
 
         const char* name() override { return "食草猫"; }
@@ -116,6 +95,6 @@ namespace JrLab {
         void draw(Plteen::dc_t* dc, float x, float y, float width, float height) override;
 
     public:
-        Animal* asexually_reproduce() override;
+        Animal* asexually_reproduce() override { return nullptr; }  // 繁殖由 SteppePopulation 负责
     };
 }
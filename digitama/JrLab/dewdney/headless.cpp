@@ -0,0 +1,104 @@
+#include "headless.hpp"
+
+#include <chrono>
+
+using namespace JrLab;
+
+/*************************************************************************************************/
+SteppeCensus JrLab::take_steppe_census(SteppeField* field, const SteppePopulation* population) {
+    SteppeCensus census;
+    int n = int(population->size());
+
+    census.day = field->current_day();
+    census.plant_energy = field->get_total_energy();
+
+    for (int idx = 0; idx < n; idx ++) {
+        const int* gene = population->gene_at(idx);
+
+        census.population[size_t(population->species_at(idx))] += 1;
+
+        for (int g = 0; g < MOVING_WAYS; g ++) {
+            census.mean_gene[g] += double(gene[g]);
+        }
+    }
+
+    if (n > 0) {
+        for (int g = 0; g < MOVING_WAYS; g ++) {
+            census.mean_gene[g] /= double(n);
+        }
+    }
+
+    return census;
+}
+
+void JrLab::write_steppe_census_header(std::ostream& out) {
+    out << "day";
+
+    for (size_t s = 0; s < size_t(SteppeSpecies::_); s ++) {
+        out << "," << steppe_species_traits(SteppeSpecies(s)).name;
+    }
+
+    out << ",plant_energy";
+
+    for (int g = 0; g < MOVING_WAYS; g ++) {
+        out << ",gene" << g;
+    }
+
+    out << std::endl;
+}
+
+void JrLab::write_steppe_census(std::ostream& out, const SteppeCensus& census) {
+    out << census.day;
+
+    for (size_t s = 0; s < size_t(SteppeSpecies::_); s ++) {
+        out << "," << census.population[s];
+    }
+
+    out << "," << census.plant_energy;
+
+    for (int g = 0; g < MOVING_WAYS; g ++) {
+        out << "," << census.mean_gene[g];
+    }
+
+    out << "\n";
+}
+
+SteppeRunReport JrLab::run_steppe_days(SteppeField* field, SteppePopulation* population, int days, std::ostream* log, int interval) {
+    SteppeRunReport report;
+    int start = field->current_day();
+    auto t0 = std::chrono::steady_clock::now();
+
+    if (log != nullptr) {
+        write_steppe_census_header(*log);
+        write_steppe_census(*log, take_steppe_census(field, population));
+    }
+
+    while (field->current_day() - start < days) {
+        field->pass_day();
+        population->pace(field, STEPPE_DAY_MS);
+
+        if (population->size() == 0U) {
+            report.extinct = true;
+        }
+
+        if (log != nullptr) {
+            int elapsed = field->current_day() - start;
+
+            if (report.extinct || (elapsed == days) || ((interval > 0) && (elapsed % interval == 0))) {
+                write_steppe_census(*log, take_steppe_census(field, population));
+            }
+        }
+
+        if (report.extinct) break;
+    }
+
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    report.days = field->current_day() - start;
+    report.survivors = int(population->size());
+
+    if (log != nullptr) {
+        log->flush();
+    }
+
+    return report;
+}
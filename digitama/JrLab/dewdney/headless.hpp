@@ -0,0 +1,37 @@
+#pragma once // 确保只被 include 一次
+
+#include "steppe.hpp"
+#include "population.hpp"
+
+#include <ostream>
+
+namespace JrLab {
+    /** 某一天草原的快照 **/
+    struct SteppeCensus {
+        int day = 0;
+        int population[size_t(JrLab::SteppeSpecies::_)] = {};
+        int plant_energy = 0;
+        double mean_gene[MOVING_WAYS] = {};     // 所有动物的平均基因, 没有动物时全是 0
+    };
+
+    /** 无窗口演化的结果 **/
+    struct SteppeRunReport {
+        int days = 0;
+        double seconds = 0.0;
+        int survivors = 0;
+        bool extinct = false;   // 还没过够天数动物就死光了
+    };
+
+    JrLab::SteppeCensus take_steppe_census(JrLab::SteppeField* field, const JrLab::SteppePopulation* population);
+
+    // CSV: day,公鸡,鸽子,奶牛,食草猫,plant_energy,gene0,...,gene7
+    void write_steppe_census_header(std::ostream& out);
+    void write_steppe_census(std::ostream& out, const JrLab::SteppeCensus& census);
+
+    /**
+     * 不限帧率地过 days 天, 没有精灵也没有补间动画, 用的是和窗口版完全相同的规则
+     * log 不为空时每 interval 天(以及最后一天)写一行快照
+     */
+    JrLab::SteppeRunReport run_steppe_days(JrLab::SteppeField* field, JrLab::SteppePopulation* population,
+        int days, std::ostream* log = nullptr, int interval = 1);
+}
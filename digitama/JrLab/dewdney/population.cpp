@@ -0,0 +1,391 @@
+#include "population.hpp"
+
+#include <plteen/datum/fixnum.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <sstream>
+
+using namespace Plteen;
+using namespace JrLab;
+
+/*************************************************************************************************/
+static const SteppeSpeciesTraits default_species_traits[] = {
+    { "公鸡", 0.5, 30, 300 },
+    { "鸽子", 0.3, 30, 300 },
+    { "奶牛", 2.0, 365, 600 },
+    { "食草猫", 0.4, 58, 1000 }
+};
+
+static const int species_count = int(SteppeSpecies::_);
+
+const SteppeSpeciesTraits& JrLab::steppe_species_traits(SteppeSpecies species) {
+    return default_species_traits[int(species)];
+}
+
+/*************************************************************************************************/
+JrLab::SteppePopulation::SteppePopulation(int row, int col) : row(row), col(col) {
+    for (int idx = 0; idx < species_count; idx ++) {
+        this->traits[idx] = default_species_traits[idx];
+    }
+}
+
+void JrLab::SteppePopulation::set_species_traits(SteppeSpecies species, const SteppeSpeciesTraits& traits) {
+    this->traits[size_t(species)] = traits;
+}
+
+uint64_t JrLab::SteppePopulation::spawn(SteppeSpecies species, const int gene[MOVING_WAYS]) {
+    return this->birth(species, gene, this->random.fork());
+}
+
+uint64_t JrLab::SteppePopulation::birth(SteppeSpecies species, const int* gene, const RandomStream& stream) {
+    const SteppeSpeciesTraits& traits = this->traits[size_t(species)];
+    size_t idx = this->ids.size();
+    uint32_t handle = 0U;
+    uint64_t id = 0U;
+
+    if (this->free_handles.empty()) {
+        handle = uint32_t(this->handle_slots.size());
+        this->handle_slots.push_back(int(idx));
+        this->handle_versions.push_back(1U);
+    } else {
+        handle = this->free_handles.back();
+        this->free_handles.pop_back();
+        this->handle_slots[handle] = int(idx);
+    }
+
+    id = (uint64_t(this->handle_versions[handle]) << 32U) | handle;
+    this->ids.push_back(id);
+    this->streams.push_back(stream);
+    this->species.push_back(uint8_t(species));
+    this->directions.push_back(uint8_t(this->streams[idx].uniform(0, MOVING_WAYS - 1)));
+    this->rs.push_back(this->row >> 1);
+    this->cs.push_back(this->col >> 1);
+    this->energies.push_back(traits.energy);
+    this->countdowns.push_back(traits.cycle);
+    this->clocks.push_back(0);
+    this->generations.push_back(1);
+    this->genes.resize(this->genes.size() + MOVING_WAYS);
+
+    if (gene == nullptr) {
+        this->streams[idx].fill_uniform(this->genes.data() + idx * MOVING_WAYS, MOVING_WAYS, 1, 10);
+    } else {
+        std::copy(gene, gene + MOVING_WAYS, this->genes.begin() + idx * MOVING_WAYS);
+    }
+
+    // 基因只在出生时确定(变异发生在出生之前), 累积权重表也只在这里算一次
+    this->gene_sums.resize(this->genes.size());
+    std::partial_sum(this->genes.begin() + idx * MOVING_WAYS, this->genes.end(), this->gene_sums.begin() + idx * MOVING_WAYS);
+
+    return id;
+}
+
+void JrLab::SteppePopulation::pace(SteppeField* field, int day_ms) {
+    int pace_ms[species_count];
+    int n = int(this->size());  // 今天出生的动物明天才开始行动
+
+    for (int idx = 0; idx < species_count; idx ++) {
+        pace_ms[idx] = fxmax(1, fl2fxi(this->traits[idx].duration * 1000.0));
+    }
+
+    this->day += 1;
+
+    for (int idx = 0; idx < n; idx ++) {
+        this->countdowns[idx] -= 1;
+        this->energies[idx] -= 1;
+
+        if (this->energies[idx] > 0) {
+            this->clocks[idx] += day_ms;
+        }
+    }
+
+    /**
+     * 攒够时间的动物按轮行动, 每轮先按格子建好占位索引, 所有动物都吃完了再一起繁殖和移动,
+     * 这样同一格里谁先吃到草就与槽位的顺序无关了
+     */
+    while (true) {
+        int actors = 0;
+
+        this->acting.assign(this->size(), 0);
+        for (int idx = 0; idx < n; idx ++) {
+            if ((this->energies[idx] > 0) && (this->clocks[idx] >= pace_ms[this->species[idx]])) {
+                this->acting[idx] = 1;
+                actors += 1;
+            }
+        }
+
+        if (actors == 0) break;
+
+        field->index_occupants(this->rs.data(), this->cs.data(), int(this->size()));
+
+        for (int idx = 0; idx < n; idx ++) {
+            if (this->acting[idx] > 0) {
+                this->eat(idx, field);
+            }
+        }
+
+        // 繁殖会往数组末尾添加新生的动物, 先集中生完, 再一口气给所有动物抽方向和移动
+        for (int idx = 0; idx < n; idx ++) {
+            if (this->acting[idx] > 0) {
+                this->clocks[idx] -= pace_ms[this->species[idx]];
+                this->reproduce(idx);
+            }
+        }
+
+        this->turn(n);
+
+        for (int idx = 0; idx < n; idx ++) {
+            if (this->acting[idx] > 0) {
+                this->move(idx);
+            }
+        }
+    }
+
+    this->bury_dead(field);
+    field->index_occupants(this->rs.data(), this->cs.data(), int(this->size()));
+}
+
+void JrLab::SteppePopulation::rewind() {
+    for (int idx = 0; idx < int(this->size()); idx ++) {
+        const SteppeSpeciesTraits& traits = this->traits[this->species[idx]];
+
+        this->countdowns[idx] = traits.cycle;
+        this->energies[idx] = traits.energy;
+        this->clocks[idx] = 0;
+    }
+
+    this->day = 0;
+}
+
+void JrLab::SteppePopulation::clear() {
+    this->ids.clear();
+    this->streams.clear();
+    this->species.clear();
+    this->directions.clear();
+    this->rs.clear();
+    this->cs.clear();
+    this->energies.clear();
+    this->countdowns.clear();
+    this->clocks.clear();
+    this->generations.clear();
+    this->genes.clear();
+    this->gene_sums.clear();
+    this->acting.clear();
+    this->free_handles.clear();
+
+    // 句柄留着, 只把版本加一, 免得旧编号又指向了新动物
+    for (uint32_t handle = 0U; handle < uint32_t(this->handle_slots.size()); handle ++) {
+        this->handle_versions[handle] += 1U;
+        this->handle_slots[handle] = -1;
+        this->free_handles.push_back(handle);
+    }
+
+    this->day = 0;
+}
+
+int JrLab::SteppePopulation::find(uint64_t id) const {
+    uint32_t handle = uint32_t(id & 0xFFFFFFFFU);
+    int idx = -1;
+
+    if ((handle < this->handle_versions.size()) && (this->handle_versions[handle] == uint32_t(id >> 32U))) {
+        idx = this->handle_slots[handle];
+    }
+
+    return idx;
+}
+
+void JrLab::SteppePopulation::reserve(size_t n) {
+    this->ids.reserve(n);
+    this->streams.reserve(n);
+    this->species.reserve(n);
+    this->directions.reserve(n);
+    this->rs.reserve(n);
+    this->cs.reserve(n);
+    this->energies.reserve(n);
+    this->countdowns.reserve(n);
+    this->clocks.reserve(n);
+    this->generations.reserve(n);
+    this->genes.reserve(n * MOVING_WAYS);
+    this->gene_sums.reserve(n * MOVING_WAYS);
+    this->acting.reserve(n);
+    this->handle_slots.reserve(n);
+    this->handle_versions.reserve(n);
+    this->free_handles.reserve(n);
+}
+
+std::string JrLab::SteppePopulation::description(int idx) const {
+    const SteppeSpeciesTraits& traits = this->traits[this->species[idx]];
+    const int* gene = this->gene_at(idx);
+    std::stringstream s;
+
+    s << "子代: " << this->generations[idx] << ";";
+    s << " 生命: " << fl2fxi(float(this->energies[idx]) / float(traits.energy) * 10000.0F) / 100.0F << "%;";
+    s << " 繁殖倒计时: " << this->countdowns[idx] << ";";
+
+    s << " 基因: [" << gene[0];
+    for (size_t i = 1; i < MOVING_WAYS; i ++) {
+        s << ", " << gene[i];
+    }
+    s << "].";
+
+    return s.str();
+}
+
+/*************************************************************************************************/
+void JrLab::SteppePopulation::eat(int idx, SteppeField* field) {
+    int r = this->rs[idx];
+    int c = this->cs[idx];
+    int food_energy = field->get_plant_energy(r, c);
+
+    // 同一格里这一轮要行动的动物抽签, 中签的吃掉整株草, 其余的就没得吃了
+    if (food_energy > 0) {
+        int n = 0;
+        const int* occupants = field->occupants_at(r, c, &n);
+        int candidates = 0;
+        int winner = idx;
+
+        for (int i = 0; i < n; i ++) {
+            if (this->acting[occupants[i]] > 0) {
+                candidates += 1;
+            }
+        }
+
+        if (candidates > 1) {
+            int lucky = this->random.uniform(0, candidates - 1);
+
+            for (int i = 0; i < n; i ++) {
+                if (this->acting[occupants[i]] > 0) {
+                    if (lucky == 0) {
+                        winner = occupants[i];
+                        break;
+                    }
+
+                    lucky -= 1;
+                }
+            }
+        }
+
+        int gain_energy = food_energy * this->streams[winner].uniform(10, 20) / 100;
+
+        this->energies[winner] = fxmin(this->traits[this->species[winner]].energy, this->energies[winner] + gain_energy);
+        field->plant_be_eaten_at(r, c);
+    }
+}
+
+void JrLab::SteppePopulation::reproduce(int idx) {
+    const SteppeSpeciesTraits& traits = this->traits[this->species[idx]];
+
+    if ((this->energies[idx] >= traits.energy / 5) && (this->countdowns[idx] <= 0)) {
+        int gene[MOVING_WAYS];
+        int offspring = int(this->size());
+
+        std::copy(this->gene_at(idx), this->gene_at(idx) + MOVING_WAYS, gene);
+        this->gene_mutate(idx, gene);
+        this->birth(SteppeSpecies(this->species[idx]), gene, this->streams[idx].fork());
+
+        this->generations[offspring] = this->generations[idx] + 1;
+        this->energies[offspring] = this->energies[idx] >> 1;
+        this->rs[offspring] = this->rs[idx];
+        this->cs[offspring] = this->cs[idx];
+
+        this->countdowns[idx] = traits.cycle;
+    }
+}
+
+void JrLab::SteppePopulation::turn(int n) {
+    const int* sums = this->gene_sums.data();
+
+    // 转过的角度就是累积权重里不超过随机数的项数, 比较结果直接相加, 不用分支也不用递归
+    for (int idx = 0; idx < n; idx ++) {
+        if (this->acting[idx] > 0) {
+            const int* cumulative = sums + size_t(idx) * MOVING_WAYS;
+            int rnd = this->streams[idx].uniform(0, cumulative[MOVING_WAYS - 1] - 1);
+            int angle = 0;
+
+            for (int i = 0; i < MOVING_WAYS - 1; i ++) {
+                angle += int(rnd >= cumulative[i]);
+            }
+
+            this->directions[idx] = uint8_t((this->directions[idx] + angle) % MOVING_WAYS);
+        }
+    }
+}
+
+void JrLab::SteppePopulation::move(int idx) {
+    int dr = 0;
+    int dc = 0;
+
+    switch (this->directions[idx]) {
+    case 0: dr = -1; break;
+    case 1: dr = -1; dc = +1; break;
+    case 2: dc = +1; break;
+    case 3: dc = dr = +1; break;
+    case 4: dr = +1; break;
+    case 5: dr = +1; dc = -1; break;
+    case 6: dc = -1; break;
+    case 7: dr = dc = -1; break;
+    default: /* deadcode */;
+    }
+
+    this->rs[idx] = wrap_index(this->rs[idx] + dr, this->row);
+    this->cs[idx] = wrap_index(this->cs[idx] + dc, this->col);
+}
+
+void JrLab::SteppePopulation::gene_mutate(int idx, int* gene) {
+    RandomStream& random = this->streams[idx];
+    int which = random.uniform(0, MOVING_WAYS - 1);
+
+    gene[which] = fxmax(1, gene[which] + random.uniform(-this->mutation_step, this->mutation_step));
+}
+
+void JrLab::SteppePopulation::bury_dead(SteppeField* field) {
+    // 从后往前扫, 填坑用的最后一只已经检查过了
+    for (int idx = int(this->size()) - 1; idx >= 0; idx --) {
+        if (this->energies[idx] <= 0) {
+            field->animal_die_at(this->rs[idx], this->cs[idx]);
+            this->erase(idx);
+        }
+    }
+}
+
+void JrLab::SteppePopulation::erase(int idx) {
+    int last = int(this->size()) - 1;
+
+    uint32_t handle = uint32_t(this->ids[idx] & 0xFFFFFFFFU);
+
+    this->handle_versions[handle] += 1U;
+    this->handle_slots[handle] = -1;
+    this->free_handles.push_back(handle);
+
+    if (idx < last) {
+        this->ids[idx] = this->ids[last];
+        this->streams[idx] = this->streams[last];
+        this->species[idx] = this->species[last];
+        this->directions[idx] = this->directions[last];
+        this->rs[idx] = this->rs[last];
+        this->cs[idx] = this->cs[last];
+        this->energies[idx] = this->energies[last];
+        this->countdowns[idx] = this->countdowns[last];
+        this->clocks[idx] = this->clocks[last];
+        this->generations[idx] = this->generations[last];
+        std::copy(this->genes.begin() + size_t(last) * MOVING_WAYS, this->genes.end(),
+            this->genes.begin() + size_t(idx) * MOVING_WAYS);
+        std::copy(this->gene_sums.begin() + size_t(last) * MOVING_WAYS, this->gene_sums.end(),
+            this->gene_sums.begin() + size_t(idx) * MOVING_WAYS);
+
+        this->handle_slots[this->ids[idx] & 0xFFFFFFFFU] = idx;
+    }
+
+    this->ids.pop_back();
+    this->streams.pop_back();
+    this->species.pop_back();
+    this->directions.pop_back();
+    this->rs.pop_back();
+    this->cs.pop_back();
+    this->energies.pop_back();
+    this->countdowns.pop_back();
+    this->clocks.pop_back();
+    this->generations.pop_back();
+    this->genes.resize(this->genes.size() - MOVING_WAYS);
+    this->gene_sums.resize(this->gene_sums.size() - MOVING_WAYS);
+}
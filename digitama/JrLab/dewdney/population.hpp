@@ -0,0 +1,108 @@
+#pragma once // 确保只被 include 一次
+
+#include "steppe.hpp"
+
+#include "../random/stream.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace JrLab {
+    static const int MOVING_WAYS = 8;
+
+    /*********************************************************************************************/
+    enum class SteppeSpecies { Rooster, Pigeon, Cow, Cat, _ };
+
+    struct SteppeSpeciesTraits {
+        const char* name;
+        double duration;    // 走一步要花的秒数
+        int cycle;          // 繁殖周期(天)
+        int energy;         // 满血能量
+    };
+
+    const JrLab::SteppeSpeciesTraits& steppe_species_traits(JrLab::SteppeSpecies species);  // 默认参数, 每个种群可以另外设定
+
+    /*********************************************************************************************/
+    /**
+     * 草原上所有动物的结构数组(structure of arrays), 每个属性一个连续的数组, 第 i 个槽位就是第 i 只动物
+     * 模拟按天推进, 不依赖任何精灵; 动物死后用最后一只填坑, 槽位会变, 编号(id)终生不变
+     * 编号的低 32 位是句柄表的下标, 高 32 位是句柄的版本, 死去动物的句柄留给下一只新生的动物,
+     * 版本加一之后旧编号自然就失效了; 数组只增不减, 繁殖高峰过后再生孩子就不用分配内存了
+     * 每轮行动前和每天结束时都会在草原上重建占位索引, 索引里存的是槽位
+     */
+    class SteppePopulation {
+    public:
+        SteppePopulation(int row, int col);
+        virtual ~SteppePopulation() {}
+
+    public:
+        void seed_random(uint64_t seed, uint64_t stream = 0U) { this->random.reseed(seed, stream); }
+        void set_species_traits(JrLab::SteppeSpecies species, const JrLab::SteppeSpeciesTraits& traits);
+        const JrLab::SteppeSpeciesTraits& species_traits(JrLab::SteppeSpecies species) const { return this->traits[size_t(species)]; }
+        void set_mutation_step(int step) { this->mutation_step = step; }    // 每次变异基因最多加减这么多
+
+    public:
+        uint64_t spawn(JrLab::SteppeSpecies species, const int gene[MOVING_WAYS] = nullptr);
+        void pace(JrLab::SteppeField* field, int day_ms);  // 过一天, day_ms 是一天对应的毫秒数
+        void rewind();  // 世界重置了, 动物原样保留, 但体力和繁殖倒计时回满
+        void clear();
+        void reserve(size_t n);
+
+    public:
+        size_t size() const { return this->ids.size(); }
+        int current_day() const { return this->day; }
+        int find(uint64_t id) const;    // 编号对应的槽位, 已经死了返回 -1
+
+    public: // 按槽位访问
+        uint64_t id_at(int idx) const { return this->ids[idx]; }
+        JrLab::SteppeSpecies species_at(int idx) const { return JrLab::SteppeSpecies(this->species[idx]); }
+        int row_at(int idx) const { return this->rs[idx]; }
+        int col_at(int idx) const { return this->cs[idx]; }
+        int energy_at(int idx) const { return this->energies[idx]; }
+        int countdown_at(int idx) const { return this->countdowns[idx]; }
+        int generation_at(int idx) const { return this->generations[idx]; }
+        const int* gene_at(int idx) const { return this->genes.data() + size_t(idx) * MOVING_WAYS; }
+        std::string description(int idx) const;
+
+    private:
+        void eat(int idx, JrLab::SteppeField* field);
+        void reproduce(int idx);
+        void turn(int n);   // 给前 n 个槽位里这一轮要行动的动物批量抽方向
+        void move(int idx);
+        void bury_dead(JrLab::SteppeField* field);
+        void gene_mutate(int idx, int* gene);
+        uint64_t birth(JrLab::SteppeSpecies species, const int* gene, const JrLab::RandomStream& stream);
+        void erase(int idx);
+
+    private:
+        std::vector<uint64_t> ids;
+        std::vector<JrLab::RandomStream> streams;   // 每只动物自己的随机数流, 从父母的流派生, 与槽位顺序无关
+        std::vector<uint8_t> species;
+        std::vector<uint8_t> directions;
+        std::vector<int> rs;
+        std::vector<int> cs;
+        std::vector<int> energies;
+        std::vector<int> countdowns;
+        std::vector<int> clocks;        // 攒下来还没用掉的毫秒数, 够走一步就行动一次
+        std::vector<int> generations;
+        std::vector<int> genes;         // 每只动物 MOVING_WAYS 个
+        std::vector<int> gene_sums;     // 基因的累积权重, 出生时算好, 转向时直接用
+        std::vector<uint8_t> acting;    // 这一轮攒够了时间要行动的动物
+
+    private: // 句柄表
+        std::vector<int> handle_slots;
+        std::vector<uint32_t> handle_versions;
+        std::vector<uint32_t> free_handles;
+
+    private:
+        JrLab::SteppeSpeciesTraits traits[size_t(JrLab::SteppeSpecies::_)];
+        JrLab::RandomStream random { "steppe population" };    // 种群的流, 只用来给初代动物派生自己的流和抽签分草
+        int mutation_step = 1;
+
+    private:
+        int row;
+        int col;
+        int day = 0;
+    };
+}
@@ -2,69 +2,91 @@
 
 #include <plteen/datum/fixnum.hpp>
 
+#include <algorithm>
+
 using namespace Plteen;
 using namespace JrLab;
 
 /*************************************************************************************************/
-static const GroundBlockType seed_tile_type = GroundBlockType::Dirt;
-static const GroundBlockType fertile_tile_type = GroundBlockType::Soil;
-static const GroundBlockType steppe_tile_type = GroundBlockType::Plain;
-static const GroundBlockType plant_tile_type = GroundBlockType::Grass;
-    
 static const int plant_energy = 120;
 static const int plant_max_energy = plant_energy * 4;
 
-/*************************************************************************************************/
-JrLab::SteppeAtlas::SteppeAtlas(int row, int col) : PlanetCuteAtlas(row, col, steppe_tile_type) {
-    this->jungle_row = 8 + row % 2;
-    this->jungle_col = 6 + col % 2;
-
-    this->jungle_r = (row - this->jungle_row) / 2;
-    this->jungle_c = (col - this->jungle_col) / 2;
-}
-
-JrLab::SteppeAtlas::~SteppeAtlas() noexcept {
-    if (this->energies != nullptr) {
-        for (int r = 0; r < this->map_row; r ++) {
-            delete [] this->energies[r];
-        }
+static inline GroundBlockType steppe_ground_type(SteppeTile tile) {
+    GroundBlockType type = GroundBlockType::Plain;
 
-        delete [] this->energies;
+    switch (tile) {
+    case SteppeTile::Plant: type = GroundBlockType::Grass; break;
+    case SteppeTile::Seed: type = GroundBlockType::Dirt; break;
+    case SteppeTile::Fertile: type = GroundBlockType::Soil; break;
+    default: /* 草原本色 */;
     }
+
+    return type;
 }
 
-int JrLab::SteppeAtlas::update(uint64_t count, uint32_t interval, uint64_t uptime) {
-    this->random_plant(this->jungle_r, this->jungle_c, this->jungle_row, this->jungle_col);
-    this->random_plant(0, 0, this->map_row, this->map_col);
+/*************************************************************************************************/
+JrLab::SteppeAtlas::SteppeAtlas(int row, int col)
+    : PlanetCuteAtlas(row, col, steppe_ground_type(SteppeTile::Steppe)), field(row, col) {}
 
-    this->day += 1;
+int JrLab::SteppeAtlas::update(uint64_t count, uint32_t interval, uint64_t uptime) {
+    // 只记账, 由世界把草原和种群放在一起推进, 否则卡顿之后草会先连长好几天
+    this->due_days += 1;
     
     return 0;
 }
 
-void JrLab::SteppeAtlas::random_plant(int r0, int c0, int row_size, int col_size) {
-    int r = random_uniform(0, row_size - 1) + r0;
-    int c = random_uniform(0, col_size - 1) + c0;
+int JrLab::SteppeAtlas::take_due_days() {
+    int n = this->due_days;
 
-    this->plant_grow_at(r, c);
+    this->due_days = 0;
+
+    return n;
 }
 
 void JrLab::SteppeAtlas::on_tilemap_load(shared_texture_t atlas) {
     PlanetCuteAtlas::on_tilemap_load(atlas);
 
-    this->energies = new int*[this->map_row];
-    for (int r = 0; r < this->map_row; r ++) {
-        this->energies[r] = new int[this->map_col];
-    }
-
+    this->field.set_listener(this);
     this->reset();
 }
 
-void JrLab::SteppeAtlas::reset() {
-    for (int r = 0; r < this->map_row; r ++) {
-        for (int c = 0; c < this->map_col; c ++) {
-            this->set_tile_type(r, c, steppe_tile_type);
-            this->energies[r][c] = 0;
+void JrLab::SteppeAtlas::on_tile_changed(int r, int c, SteppeTile tile) {
+    this->set_tile_type(r, c, steppe_ground_type(tile));
+}
+
+/*************************************************************************************************/
+JrLab::SteppeField::SteppeField(int row, int col, int jungle_row, int jungle_col) : row(row), col(col) {
+    this->jungle_row = fxmin((jungle_row > 0) ? jungle_row : (8 + row % 2), row);
+    this->jungle_col = fxmin((jungle_col > 0) ? jungle_col : (6 + col % 2), col);
+
+    this->jungle_r = (row - this->jungle_row) / 2;
+    this->jungle_c = (col - this->jungle_col) / 2;
+
+    this->energies.assign(size_t(row) * size_t(col), 0);
+}
+
+void JrLab::SteppeField::pass_day() {
+    this->random_plant(this->jungle_r, this->jungle_c, this->jungle_row, this->jungle_col);
+    this->random_plant(0, 0, this->row, this->col);
+
+    this->day += 1;
+}
+
+void JrLab::SteppeField::random_plant(int r0, int c0, int row_size, int col_size) {
+    int r = this->random.uniform(0, row_size - 1) + r0;
+    int c = this->random.uniform(0, col_size - 1) + c0;
+
+    this->plant_grow_at(r, c);
+}
+
+void JrLab::SteppeField::reset() {
+    std::fill(this->energies.begin(), this->energies.end(), 0);
+
+    if (this->listener != nullptr) {
+        for (int r = 0; r < this->row; r ++) {
+            for (int c = 0; c < this->col; c ++) {
+                this->listener->on_tile_changed(r, c, SteppeTile::Steppe);
+            }
         }
     }
 
@@ -72,42 +94,115 @@ void JrLab::SteppeAtlas::reset() {
     this->day = 0;
 }
 
+void JrLab::SteppeField::notify_tile_changed(int r, int c, SteppeTile tile) {
+    if (this->listener != nullptr) {
+        this->listener->on_tile_changed(r, c, tile);
+    }
+}
+
 /*************************************************************************************************/
-int JrLab::SteppeAtlas::get_plant_energy(int r, int c) {
-    r = wrap_index(r, this->map_row);
-    c = wrap_index(c, this->map_col);
+int JrLab::SteppeField::get_plant_energy(int r, int c) {
+    r = wrap_index(r, this->row);
+    c = wrap_index(c, this->col);
 
-    return this->energies[r][c];
+    return this->energies[r * this->col + c];
 }
 
-void JrLab::SteppeAtlas::plant_grow_at(int r, int c) {
-    r = wrap_index(r, this->map_row);
-    c = wrap_index(c, this->map_col);
+void JrLab::SteppeField::plant_grow_at(int r, int c) {
+    r = wrap_index(r, this->row);
+    c = wrap_index(c, this->col);
     
-    int origin_energy = this->energies[r][c];
+    int& energy = this->energies[r * this->col + c];
+    int origin_energy = energy;
 
-    this->energies[r][c] = fxmin(this->energies[r][c] + plant_energy, plant_max_energy);
-    this->total_energy += (this->energies[r][c] - origin_energy);
-    this->set_tile_type(r, c, plant_tile_type);
+    energy = fxmin(energy + plant_energy, plant_max_energy);
+    this->total_energy += (energy - origin_energy);
+    this->notify_tile_changed(r, c, SteppeTile::Plant);
 }
 
-void JrLab::SteppeAtlas::plant_be_eaten_at(int r, int c) {
-    r = wrap_index(r, this->map_row);
-    c = wrap_index(c, this->map_col);
+void JrLab::SteppeField::plant_be_eaten_at(int r, int c) {
+    r = wrap_index(r, this->row);
+    c = wrap_index(c, this->col);
+
+    this->total_energy -= this->energies[r * this->col + c];
+    this->energies[r * this->col + c] = 0;
+    this->notify_tile_changed(r, c, SteppeTile::Seed);
+}
+
+/*************************************************************************************************/
+void JrLab::SteppeField::index_occupants(const int* rs, const int* cs, int n) {
+    size_t tiles = size_t(this->row) * size_t(this->col);
+
+    this->occupant_starts.assign(tiles + 1U, 0);
+    this->occupants.resize(n);
+
+    for (int idx = 0; idx < n; idx ++) {
+        this->occupant_starts[rs[idx] * this->col + cs[idx]] += 1;
+    }
+
+    // 先累加成每格的结尾, 倒着放一遍之后就退回到每格的开头, 同一格里保持槽位的顺序
+    for (size_t t = 1; t <= tiles; t ++) {
+        this->occupant_starts[t] += this->occupant_starts[t - 1];
+    }
 
-    this->total_energy -= this->energies[r][c];
-    this->energies[r][c] = 0;
-    this->set_tile_type(r, c, seed_tile_type);
+    for (int idx = n - 1; idx >= 0; idx --) {
+        this->occupants[-- this->occupant_starts[rs[idx] * this->col + cs[idx]]] = idx;
+    }
 }
 
-void JrLab::SteppeAtlas::animal_die_at(int r, int c) {
-    r = wrap_index(r, this->map_row);
-    c = wrap_index(c, this->map_col);
+const int* JrLab::SteppeField::occupants_at(int r, int c, int* n) {
+    const int* slots = nullptr;
+    int count = 0;
+
+    if (!this->occupant_starts.empty()) {
+        int t = wrap_index(r, this->row) * this->col + wrap_index(c, this->col);
+
+        slots = this->occupants.data() + this->occupant_starts[t];
+        count = this->occupant_starts[t + 1] - this->occupant_starts[t];
+    }
+
+    SET_BOX(n, count);
+
+    return slots;
+}
+
+int JrLab::SteppeField::occupant_count(int r, int c) {
+    int n = 0;
+
+    this->occupants_at(r, c, &n);
+
+    return n;
+}
+
+int JrLab::SteppeField::occupants_around(int r, int c, int radius, std::vector<int>& slots) {
+    int total = 0;
+
+    // 半径超过半张地图时环绕回来的格子只算一次
+    int rspan = fxmin(radius * 2 + 1, this->row);
+    int cspan = fxmin(radius * 2 + 1, this->col);
+
+    for (int dr = 0; dr < rspan; dr ++) {
+        for (int dc = 0; dc < cspan; dc ++) {
+            int n = 0;
+            const int* tile = this->occupants_at(r - radius + dr, c - radius + dc, &n);
+
+            slots.insert(slots.end(), tile, tile + n);
+            total += n;
+        }
+    }
+
+    return total;
+}
+
+/*************************************************************************************************/
+void JrLab::SteppeField::animal_die_at(int r, int c) {
+    r = wrap_index(r, this->row);
+    c = wrap_index(c, this->col);
 
     /** TODO
      * How to calculate the energy produced by dead body?
      * Meanwhile leaving the energy as-is.
      */
 
-    this->set_tile_type(r, c, fertile_tile_type);
+    this->notify_tile_changed(r, c, SteppeTile::Fertile);
 }
@@ -2,16 +2,37 @@
 
 #include <plteen/bang.hpp>
 
+#include "../random/stream.hpp"
+
+#include <vector>
+
 namespace JrLab {
+    static const int STEPPE_DAY_MS = 250;   // 窗口里每秒过 4 天
+
     /*********************************************************************************************/
-    class SteppeAtlas : public Plteen::PlanetCuteAtlas {
+    enum class SteppeTile { Steppe, Plant, Seed, Fertile };
+
+    class ISteppeFieldListener {
     public:
-        SteppeAtlas(int row, int col);
-        virtual ~SteppeAtlas() noexcept;
+        virtual ~ISteppeFieldListener() {}
 
     public:
-        int preferred_local_fps() override { return 4; }
-        int update(uint64_t count, uint32_t interval, uint64_t uptime) override;
+        virtual void on_tile_changed(int r, int c, JrLab::SteppeTile tile) = 0;
+    };
+
+    /**
+     * 草原的模拟部分: 植物的能量, 日子和动物占位索引, 不需要纹理, 无窗口的实验直接用它
+     * 地块的变化通过 listener 通知出去, 画不画由监听者决定
+     */
+    class SteppeField {
+    public:
+        SteppeField(int row, int col, int jungle_row = 0, int jungle_col = 0);    // 丛林默认 8x6 左右, 放在正中间
+        virtual ~SteppeField() noexcept {}
+
+    public:
+        void pass_day();    // 丛林和整片草原各随机长一棵草, 然后过一天
+        void set_listener(JrLab::ISteppeFieldListener* listener) { this->listener = listener; }
+        void seed_random(uint64_t seed, uint64_t stream = 0U) { this->random.reseed(seed, stream); }
 
     public:
         void animal_die_at(int r, int c);
@@ -20,25 +41,65 @@ namespace JrLab {
         int get_plant_energy(int r, int c);
         int get_total_energy() { return this->total_energy; }
 
+    public: // 动物占位索引, 按槽位计数排序, 同一格里的动物排在一起
+        void index_occupants(const int* rs, const int* cs, int n);
+        const int* occupants_at(int r, int c, int* n);
+        int occupant_count(int r, int c);
+        int occupants_around(int r, int c, int radius, std::vector<int>& slots);  // (2radius+1)^2 格的邻域, 包括 (r, c)
+
     public:
         void reset();
         int current_day() { return this->day; }
-
-    protected:
-        void on_tilemap_load(Plteen::shared_texture_t atlas) override;
+        int field_row() { return this->row; }
+        int field_col() { return this->col; }
 
     private:
         void random_plant(int r0, int c0, int row_size, int col_size);
+        void notify_tile_changed(int r, int c, JrLab::SteppeTile tile);
+
+    private:
+        std::vector<int> energies;
+        int total_energy = 0;
 
     private:
-        int** energies;
-        int total_energy;
+        std::vector<int> occupant_starts;   // 第 i 格的动物是 occupants[starts[i], starts[i + 1])
+        std::vector<int> occupants;
 
     private:
-        int day;
+        JrLab::ISteppeFieldListener* listener = nullptr;
+        JrLab::RandomStream random { "steppe" };
+        int row;
+        int col;
+        int day = 0;
         int jungle_r;
         int jungle_c;
         int jungle_row;
         int jungle_col;
     };
+
+    /*********************************************************************************************/
+    class SteppeAtlas : public Plteen::PlanetCuteAtlas, public JrLab::ISteppeFieldListener {
+    public:
+        SteppeAtlas(int row, int col);
+        virtual ~SteppeAtlas() noexcept {}
+
+    public:
+        int preferred_local_fps() override { return 1000 / STEPPE_DAY_MS; }
+        int update(uint64_t count, uint32_t interval, uint64_t uptime) override;
+
+    public:
+        JrLab::SteppeField* get_field() { return &this->field; }
+        int get_total_energy() { return this->field.get_total_energy(); }
+        int current_day() { return this->field.current_day(); }
+        void reset() { this->field.reset(); }
+        int take_due_days();    // 计时器到点但还没过的天数, 取走之后清零
+
+    protected:
+        void on_tilemap_load(Plteen::shared_texture_t atlas) override;
+        void on_tile_changed(int r, int c, JrLab::SteppeTile tile) override;
+
+    private:
+        JrLab::SteppeField field;
+        int due_days = 0;
+    };
 }
@@ -0,0 +1,191 @@
+#include "sweep.hpp"
+#include "headless.hpp"
+
+#include "../parallel/workpool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+using namespace JrLab;
+
+/*************************************************************************************************/
+namespace {
+    struct SteppeRunSummary {
+        int days = 0;
+        int population[size_t(SteppeSpecies::_)] = {};
+        double gene_sum[MOVING_WAYS] = {};
+        double gene_square_sum[MOVING_WAYS] = {};
+        long long survivors = 0;
+    };
+}
+
+static std::vector<SteppeSweepConfig> expand_grid(const SteppeSweepOptions& options) {
+    std::vector<SteppeSweepConfig> configs;
+
+    for (int cycle : options.cycle_percents) {
+        for (int energy : options.energy_percents) {
+            for (auto& jungle : options.jungles) {
+                for (int step : options.mutation_steps) {
+                    SteppeSweepConfig config;
+
+                    config.cycle_percent = cycle;
+                    config.energy_percent = energy;
+                    config.jungle_row = jungle.first;
+                    config.jungle_col = jungle.second;
+                    config.mutation_step = step;
+                    configs.push_back(config);
+                }
+            }
+        }
+    }
+
+    return configs;
+}
+
+static SteppeRunSummary run_once(const SteppeSweepOptions& options, const SteppeSweepConfig& config, uint64_t stream) {
+    SteppeField field(options.row, options.col, config.jungle_row, config.jungle_col);
+    SteppePopulation population(options.row, options.col);
+    SteppeRunSummary summary;
+
+    // 草原和种群各占一条流
+    field.seed_random(options.seed, stream * 2U);
+    population.seed_random(options.seed, stream * 2U + 1U);
+    population.set_mutation_step(config.mutation_step);
+
+    for (size_t s = 0; s < size_t(SteppeSpecies::_); s ++) {
+        SteppeSpeciesTraits traits = steppe_species_traits(SteppeSpecies(s));
+
+        traits.cycle = std::max(1, traits.cycle * config.cycle_percent / 100);
+        traits.energy = std::max(1, traits.energy * config.energy_percent / 100);
+        population.set_species_traits(SteppeSpecies(s), traits);
+    }
+
+    for (int idx = 0; idx < options.founders; idx ++) {
+        for (size_t s = 0; s < size_t(SteppeSpecies::_); s ++) {
+            population.spawn(SteppeSpecies(s));
+        }
+    }
+
+    summary.days = run_steppe_days(&field, &population, options.days).days;
+    summary.survivors = (long long)(population.size());
+
+    for (int idx = 0; idx < int(population.size()); idx ++) {
+        const int* gene = population.gene_at(idx);
+
+        summary.population[size_t(population.species_at(idx))] += 1;
+
+        for (int g = 0; g < MOVING_WAYS; g ++) {
+            summary.gene_sum[g] += double(gene[g]);
+            summary.gene_square_sum[g] += double(gene[g]) * double(gene[g]);
+        }
+    }
+
+    return summary;
+}
+
+/*************************************************************************************************/
+SteppeSweepReport JrLab::run_steppe_sweep(const SteppeSweepOptions& options) {
+    SteppeSweepReport report;
+    std::vector<SteppeSweepConfig> configs = expand_grid(options);
+    int replicates = std::max(options.replicates, 1);
+    int run_count = int(configs.size()) * replicates;
+    std::vector<SteppeRunSummary> summaries(run_count);
+    WorkPool workers(options.threads);
+    auto t0 = std::chrono::steady_clock::now();
+
+    // 每次模拟都是一个任务, 结果写进自己的格子, 各个核之间除了取任务之外没有任何同步
+    workers.run(run_count, [&](int run) {
+        summaries[run] = run_once(options, configs[run / replicates], uint64_t(run));
+    });
+
+    for (size_t i = 0; i < configs.size(); i ++) {
+        SteppeSweepEntry entry;
+        double gene_sum[MOVING_WAYS] = {};
+        double gene_square_sum[MOVING_WAYS] = {};
+        long long survivors = 0;
+
+        entry.config = configs[i];
+        entry.runs = replicates;
+
+        for (int rep = 0; rep < replicates; rep ++) {
+            const SteppeRunSummary& summary = summaries[i * replicates + rep];
+
+            entry.mean_days += double(summary.days);
+            survivors += summary.survivors;
+
+            if (summary.survivors == 0) {
+                entry.extinctions += 1;
+            }
+
+            for (size_t s = 0; s < size_t(SteppeSpecies::_); s ++) {
+                entry.mean_population[s] += double(summary.population[s]);
+
+                if (summary.population[s] > 0) {
+                    entry.survivals[s] += 1;
+                }
+            }
+
+            for (int g = 0; g < MOVING_WAYS; g ++) {
+                gene_sum[g] += summary.gene_sum[g];
+                gene_square_sum[g] += summary.gene_square_sum[g];
+            }
+        }
+
+        entry.mean_days /= double(replicates);
+
+        for (size_t s = 0; s < size_t(SteppeSpecies::_); s ++) {
+            entry.mean_population[s] /= double(replicates);
+        }
+
+        if (survivors > 0) {
+            for (int g = 0; g < MOVING_WAYS; g ++) {
+                double mean = gene_sum[g] / double(survivors);
+
+                entry.gene_mean[g] = mean;
+                entry.gene_stddev[g] = std::sqrt(std::max(gene_square_sum[g] / double(survivors) - mean * mean, 0.0));
+            }
+        }
+
+        report.table.push_back(entry);
+    }
+
+    report.runs = run_count;
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    return report;
+}
+
+void JrLab::write_steppe_sweep(std::ostream& out, const SteppeSweepReport& report) {
+    out << "cycle_percent,energy_percent,jungle_row,jungle_col,mutation_step,runs,extinctions,mean_days";
+
+    for (size_t s = 0; s < size_t(SteppeSpecies::_); s ++) {
+        const char* name = steppe_species_traits(SteppeSpecies(s)).name;
+
+        out << "," << name << "_survivals," << name << "_population";
+    }
+
+    for (int g = 0; g < MOVING_WAYS; g ++) {
+        out << ",gene" << g << "_mean,gene" << g << "_stddev";
+    }
+
+    out << std::endl;
+
+    for (auto& entry : report.table) {
+        out << entry.config.cycle_percent << "," << entry.config.energy_percent << ","
+            << entry.config.jungle_row << "," << entry.config.jungle_col << "," << entry.config.mutation_step << ","
+            << entry.runs << "," << entry.extinctions << "," << entry.mean_days;
+
+        for (size_t s = 0; s < size_t(SteppeSpecies::_); s ++) {
+            out << "," << entry.survivals[s] << "," << entry.mean_population[s];
+        }
+
+        for (int g = 0; g < MOVING_WAYS; g ++) {
+            out << "," << entry.gene_mean[g] << "," << entry.gene_stddev[g];
+        }
+
+        out << "\n";
+    }
+
+    out.flush();
+}
@@ -0,0 +1,58 @@
+#pragma once // 确保只被 include 一次
+
+#include "population.hpp"
+
+#include <cstdint>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace JrLab {
+    /** 一组参数, 繁殖周期和满血能量按各物种默认值的百分比缩放 **/
+    struct SteppeSweepConfig {
+        int cycle_percent = 100;
+        int energy_percent = 100;
+        int jungle_row = 8;
+        int jungle_col = 6;
+        int mutation_step = 1;
+    };
+
+    struct SteppeSweepOptions {
+        int row = 24;
+        int col = 36;
+        int days = 10000;
+        int founders = 1;           // 每个物种一开始放几只
+        int replicates = 8;         // 每组参数独立跑几次
+        uint64_t seed = 0U;         // 第 i 次模拟用 (种子, i) 播种, 结果与线程数和调度顺序无关
+        int threads = 0;            // 0 表示使用所有的 CPU 核
+
+    public: // 参数网格, 报告里是它们的笛卡尔积
+        std::vector<int> cycle_percents = { 100 };
+        std::vector<int> energy_percents = { 100 };
+        std::vector<std::pair<int, int>> jungles = { { 8, 6 } };
+        std::vector<int> mutation_steps = { 1 };
+    };
+
+    struct SteppeSweepEntry {
+        JrLab::SteppeSweepConfig config;
+        int runs = 0;
+        int extinctions = 0;                                        // 动物全部死光的次数
+        double mean_days = 0.0;                                     // 平均存活天数
+        int survivals[size_t(JrLab::SteppeSpecies::_)] = {};        // 该物种活到最后的次数
+        double mean_population[size_t(JrLab::SteppeSpecies::_)] = {};
+        double gene_mean[MOVING_WAYS] = {};                         // 所有幸存者的基因分布
+        double gene_stddev[MOVING_WAYS] = {};
+    };
+
+    struct SteppeSweepReport {
+        long long runs = 0;
+        double seconds = 0.0;
+        std::vector<JrLab::SteppeSweepEntry> table;     // 和参数网格的展开顺序一致
+    };
+
+    // 在所有的 CPU 核上跑完整个参数网格, 每次模拟都有自己的草原, 种群和随机数流
+    JrLab::SteppeSweepReport run_steppe_sweep(const JrLab::SteppeSweepOptions& options);
+
+    // 把报告写成 CSV, 每组参数一行
+    void write_steppe_sweep(std::ostream& out, const JrLab::SteppeSweepReport& report);
+}
@@ -55,9 +55,9 @@ void JrLab::DrunkardWalkWorld::update(uint64_t interval, uint32_t count, uint64_
 
 /*************************************************************************************************/
 void JrLab::DrunkardWalkWorld::random_walk(Bracer* who) {
-    // random_uniform(-1, 1) 产生一个位于区间 [-1, 1] 的随机整数
-    float x = random_uniform(-1, 1); // 左右移动或不动
-    float y = random_uniform(-1, 1); // 上下移动或不动
+    // uniform(-1, 1) 产生一个位于区间 [-1, 1] 的随机整数
+    float x = float(this->random.uniform(-1, 1)); // 左右移动或不动
+    float y = float(this->random.uniform(-1, 1)); // 上下移动或不动
 
     this->pen_down(who);
     this->glide(step_duration, who, Point<float>(x, y) * step_size);
@@ -66,7 +66,7 @@ void JrLab::DrunkardWalkWorld::random_walk(Bracer* who) {
 
 void JrLab::DrunkardWalkWorld::drunkard_walk(Bracer* who) {
     // 产生位于区间 [0, 100] 的随机整数
-    int chance = random_uniform(0, 100);
+    int chance = this->random.uniform(0, 100);
     float x = 0.0F;
     float y = 0.0F;
     
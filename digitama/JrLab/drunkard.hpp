@@ -2,6 +2,8 @@
 
 #include <plteen/bang.hpp>
 
+#include "random/stream.hpp"
+
 namespace JrLab {
     class DrunkardWalkWorld : public Plteen::TheBigBang {
     public:
@@ -28,5 +30,8 @@ namespace JrLab {
         Plteen::Sprite* beach;
         Plteen::SpriteGridSheet* tent;
         Plteen::Tracklet* track;
+
+    private:
+        JrLab::RandomStream random { "drunkard" };
     };
 }
@@ -1,7 +1,5 @@
 #include "evolution.hpp"
 
-#include <algorithm>
-
 using namespace Plteen;
 using namespace JrLab;
 
@@ -9,6 +7,12 @@ using namespace JrLab;
 static const char* matrics_fmt = "在线天数: %d    消费者总数: %d    生产者能量总和: %d";
 
 /*************************************************************************************************/
+JrLab::EvolutionWorld::~EvolutionWorld() {
+    if (this->population != nullptr) {
+        delete this->population;
+    }
+}
+
 void JrLab::EvolutionWorld::load(float width, float height) {
     TheBigBang::load(width, height);
     
@@ -24,10 +28,13 @@ void JrLab::EvolutionWorld::load(float width, float height) {
     //this->phistory = this->spawn<Historylet>(200.0F, 100.0F, ROYALBLUE);
     //this->ehistory = this->spawn<Historylet>(200.0F, 100.0F, ORANGE);
 
-    this->animals.push_back(this->spawn<TMRooster>(this->row, this->col));
-    this->animals.push_back(this->spawn<TMPigeon>(this->row, this->col));
-    this->animals.push_back(this->spawn<TMCow>(this->row, this->col));
-    this->animals.push_back(this->spawn<TMCat>(this->row, this->col));
+    this->population = new SteppePopulation(this->row, this->col);
+    this->sprites.reserve(this->sprite_budget);
+    this->population->spawn(SteppeSpecies::Rooster);
+    this->population->spawn(SteppeSpecies::Pigeon);
+    this->population->spawn(SteppeSpecies::Cow);
+    this->population->spawn(SteppeSpecies::Cat);
+    this->bind_sprites();
 
     /* 简单配置物体 */
     this->steppe->scale_to(this->size_hint / this->steppe->get_logic_tile_region().width());
@@ -54,7 +61,10 @@ void JrLab::EvolutionWorld::on_mission_start(float width, float height) {
     //this->ehistory->clear();
 
     // Animals remain the same to simulate the natural disaster
-    for (auto animal : this->animals) {
+    this->population->rewind();
+
+    for (auto binding : this->sprites) {
+        auto animal = binding.second;
         auto self = animal->unsafe_metadata<IToroidalMovingAnimal>();
 
         this->steppe->glide_to_logic_tile(self->pace_duration(), animal,
@@ -64,78 +74,105 @@ void JrLab::EvolutionWorld::on_mission_start(float width, float height) {
 }
 
 void JrLab::EvolutionWorld::update(uint64_t count, uint32_t interval, uint64_t uptime) {
-    if (this->animals.empty()) {
+    SteppeField* field = this->steppe->get_field();
+    int days = this->steppe->take_due_days();
+
+    // 草原和种群一天一天地一起推进, 与 run_steppe_days 相同, 结果不受帧率影响
+    for (int d = 0; d < days; d ++) {
+        field->pass_day();
+        this->population->pace(field, STEPPE_DAY_MS);
+    }
+
+    if (this->population->size() == 0U) {
         this->world_info->set_text_color(FIREBRICK);
         //this->phistory->set_pen_color(CRIMSON);
         //this->ehistory->set_pen_color(CRIMSON);
     } else {
-        std::vector<Animal*> offsprings;
-        Margin overlay = this->steppe->get_map_overlay();
-        Box tile = this->steppe->get_logic_tile_region();
-        bool has_death = false;
+        this->sync_sprites();
+        this->bind_sprites();
+    }
 
-        for (auto animal : this->animals) {  
-            auto self = animal->unsafe_metadata<IToroidalMovingAnimal>();
-          
-            self->on_time_fly(this->steppe->current_day());
+    this->update_world_info();
+}
+
+void JrLab::EvolutionWorld::sync_sprites() {
+    Box tile = this->steppe->get_logic_tile_region();
 
+    for (auto it = this->sprites.begin(); it != this->sprites.end(); ) {
+        auto animal = it->second;
+        auto self = animal->unsafe_metadata<IToroidalMovingAnimal>();
+
+        if (!self->is_alive()) {
+            this->recycle_sprite(animal, self->current_species());
+            it = this->sprites.erase(it);
+        } else {
             if (animal->motion_stopped()) {
-                if (self->is_alive()) {
-                    this->animal_try_eat(animal, self);
-                    this->animal_try_reproduce(animal, self, offsprings, 0.0F, overlay.bottom);
-                    this->animal_move(animal, self, tile.width(), tile.height());
-                    this->notify_updated(animal);
-                } else {
-                    has_death = true;
-                }
-            }
-        }
+                int dr, dc;
 
-        if (has_death) {
-            this->clear_dead_animals();
-        }
+                self->sync(&dr, &dc);
+
+                if ((dr != 0) || (dc != 0)) {
+                    this->animal_move(animal, self, dr, dc, tile.width(), tile.height());
+                }
 
-        if (!offsprings.empty()) {
-            for (auto offspring : offsprings) {
-                this->animals.push_back(offspring);
+                this->notify_updated(animal);
             }
-            
-            offsprings.clear();
+
+            ++ it;
         }
     }
-
-    this->update_world_info();
 }
 
-void JrLab::EvolutionWorld::animal_try_eat(Animal* animal, IToroidalMovingAnimal* self) {
-    int r = self->current_row();
-    int c = self->current_col();
-    int plant_energy = this->steppe->get_plant_energy(r, c);
+void JrLab::EvolutionWorld::bind_sprites() {
+    Margin overlay = this->steppe->get_map_overlay();
+    int n = int(this->population->size());
+
+    for (int idx = 0; (idx < n) && (this->sprites.size() < this->sprite_budget); idx ++) {
+        uint64_t id = this->population->id_at(idx);
+
+        if (this->sprites.find(id) == this->sprites.end()) {
+            auto animal = this->make_sprite(idx);
 
-    if (plant_energy > 0) {
-        self->eat(plant_energy);
-        this->steppe->plant_be_eaten_at(r, c);
+            this->sprites[id] = animal;
+            this->steppe->move_to_logic_tile(animal,
+                this->population->row_at(idx), this->population->col_at(idx), MatterPort::CC,
+                MatterPort::CB, { 0.0F, overlay.bottom });
+        }
     }
 }
 
-void JrLab::EvolutionWorld::animal_try_reproduce(Animal* animal, IToroidalMovingAnimal* self, std::vector<Animal*>& offsprings, float dx, float dy) {
-    if (self->can_reproduce()) {
-        auto offspring = animal->asexually_reproduce();
-        auto offself = offspring->unsafe_metadata<IToroidalMovingAnimal>();
+Animal* JrLab::EvolutionWorld::make_sprite(int idx) {
+    SteppeSpecies species = this->population->species_at(idx);
+    std::vector<Animal*>& pool = this->idle_sprites[size_t(species)];
+    uint64_t id = this->population->id_at(idx);
+    Animal* animal = nullptr;
+
+    if (!pool.empty()) {
+        animal = pool.back();
+        pool.pop_back();
+        animal->unsafe_metadata<IToroidalMovingAnimal>()->rebind(id);
+        animal->show(true);
+    } else {
+        switch (species) {
+        case SteppeSpecies::Rooster: animal = new TMRooster(this->population, id); break;
+        case SteppeSpecies::Pigeon: animal = new TMPigeon(this->population, id); break;
+        case SteppeSpecies::Cow: animal = new TMCow(this->population, id); break;
+        default: animal = new TMCat(this->population, id); break;
+        }
 
-        offsprings.push_back(this->insert(offspring));
-        this->steppe->move_to_logic_tile(offspring,
-                    offself->current_row(), offself->current_col(), MatterPort::CC,
-                    MatterPort::CB, { dx, dy });
+        this->insert(animal);
     }
-}
 
-void JrLab::EvolutionWorld::animal_move(Animal* animal, IToroidalMovingAnimal* self, float tile_width, float tile_height) {
-    int dr, dc;
+    return animal;
+}
 
-    self->turn();
-    self->move(&dr, &dc);
+void JrLab::EvolutionWorld::recycle_sprite(Animal* animal, SteppeSpecies species) {
+    // 精灵和它的元数据都不释放, 藏起来留给同一物种的下一只动物
+    animal->show(false);
+    this->idle_sprites[size_t(species)].push_back(animal);
+}
 
+void JrLab::EvolutionWorld::animal_move(Animal* animal, IToroidalMovingAnimal* self, int dr, int dc, float tile_width, float tile_height) {
     if ((fxabs(dr) > 1) || (fxabs(dc) > 1)) {
         this->move(animal, dc * tile_width, dr * tile_height);
     } else {
@@ -143,26 +180,6 @@ void JrLab::EvolutionWorld::animal_move(Animal* animal, IToroidalMovingAnimal* s
     }
 }
 
-void JrLab::EvolutionWorld::clear_dead_animals() {
-    std::for_each(this->animals.begin(), this->animals.end(),
-        [&, this](Animal*& animal) {
-            auto self = animal->unsafe_metadata<IToroidalMovingAnimal>();
-            
-            if (!self->is_alive()) {
-                int r = self->current_row();
-                int c = self->current_col();
-
-                this->steppe->animal_die_at(r, c);
-
-                this->remove(animal);
-                animal = nullptr;
-            }
-        });
-
-    auto it = std::remove(this->animals.begin(), this->animals.end(), static_cast<Animal*>(nullptr));
-    this->animals.erase(it, this->animals.end());
-}
-
 /**************************************************************************************************/
 bool JrLab::EvolutionWorld::can_select(IMatter* m) {
     return (m == this->agent);
@@ -196,7 +213,7 @@ bool JrLab::EvolutionWorld::update_tooltip(IMatter* m, float lx, float ly, float
 
 void JrLab::EvolutionWorld::update_world_info() {
     int day = this->steppe->current_day();
-    int n = int(this->animals.size());
+    int n = int(this->population->size());
     int e = this->steppe->get_total_energy();
     
     this->world_info->set_text(MatterPort::RB, matrics_fmt, day, n, e);
@@ -3,16 +3,19 @@
 #include <plteen/bang.hpp>
 
 #include "dewdney/steppe.hpp"
+#include "dewdney/population.hpp"
 #include "dewdney/animal.hpp"
 
+#include <unordered_map>
 #include <vector>
 
 namespace JrLab {
     /*********************************************************************************************/
     class EvolutionWorld : public Plteen::TheBigBang {
     public:
-        EvolutionWorld(float size_hint = 32.0F) : TheBigBang("演化游戏"), size_hint(size_hint) {}
-        virtual ~EvolutionWorld() {}
+        EvolutionWorld(float size_hint = 32.0F, size_t sprite_budget = 512U)
+            : TheBigBang("演化游戏"), size_hint(size_hint), sprite_budget(sprite_budget) {}
+        virtual ~EvolutionWorld();
         
     public:
         void load(float width, float height) override;
@@ -28,10 +31,11 @@ namespace JrLab {
         bool update_tooltip(Plteen::IMatter* m, float lx, float ly, float gx, float gy) override;
 
     private:
-        void animal_try_eat(Plteen::Animal* animal, IToroidalMovingAnimal* self);
-        void animal_try_reproduce(Plteen::Animal* animal, IToroidalMovingAnimal* self, std::vector<Plteen::Animal*>& offsprings, float dx, float dy);
-        void animal_move(Plteen::Animal* animal, IToroidalMovingAnimal* self, float tile_width, float tile_height);
-        void clear_dead_animals();
+        void animal_move(Plteen::Animal* animal, IToroidalMovingAnimal* self, int dr, int dc, float tile_width, float tile_height);
+        void sync_sprites();
+        void bind_sprites();
+        Plteen::Animal* make_sprite(int idx);
+        void recycle_sprite(Plteen::Animal* animal, JrLab::SteppeSpecies species);
 
     private:
         void reset_world();
@@ -39,7 +43,9 @@ namespace JrLab {
             
     private: /* 本世界中的物体 */
         JrLab::SteppeAtlas* steppe;
-        std::vector<Plteen::Animal*> animals;
+        JrLab::SteppePopulation* population = nullptr;
+        std::unordered_map<uint64_t, Plteen::Animal*> sprites;  // 动物编号 => 精灵, 只给一部分动物配精灵
+        std::vector<Plteen::Animal*> idle_sprites[size_t(JrLab::SteppeSpecies::_)];  // 动物死后藏起来的精灵, 按物种回收
         //Plteen::Historylet* phistory;
         //Plteen::Historylet* ehistory;
         Plteen::Labellet* world_info;
@@ -50,5 +56,6 @@ namespace JrLab {
 
     private:
         float size_hint;
+        size_t sprite_budget;   // 整张地图都在屏幕上, 所以精灵的数量只受这个预算限制
     };
 }
@@ -10,24 +10,60 @@ using namespace std::filesystem;
 #define DEFAULT_CONWAY_DEMO digimon_path("demo/conway/typical", ".gof")
 
 static const int default_frame_rate = 8;
-static const char* generation_fmt = "Generation: %d";
+static const char* generation_fmt = "Generation: %lld";
+static const char* cycle_fmt = "Generation: %lld (Period: %d)";
+static const char* stats_fmt = "演化 %.3fms 同步 %.3fms 绘制 %.3fms 人口 %lld +%lld -%lld";
 
 /*************************************************************************************************/
 static const char AUTO_KEY = 'a';
 static const char STOP_KEY = 's';
 static const char PACE_KEY = 'p';
+static const char FAST_KEY = 'f';
+static const char JUMP_KEY = 'j';
 static const char EDIT_KEY = 'e';
+static const char UNDO_KEY = 'u';
+static const char REDO_KEY = 'y';
+static const char BACK_KEY = 'b';
 static const char LOAD_KEY = 'l';
 static const char RAND_KEY = 'r';
 static const char RSET_KEY = 'z';
 static const char WRTE_KEY = 'w';
 
-static const char ordered_keys[] = { AUTO_KEY, STOP_KEY, PACE_KEY, EDIT_KEY, LOAD_KEY, WRTE_KEY, RAND_KEY, RSET_KEY };
-static const uint32_t colors_for_auto[] = { GRAY, GREEN, GRAY, GRAY, GRAY, GRAY, GRAY, GRAY };
-static const uint32_t colors_for_stop[]  = { GREEN, GRAY, GREEN, GREEN, GRAY, GRAY, GRAY, GRAY };
-static const uint32_t colors_for_edit[] = { GREEN, GRAY, GREEN, GRAY, GREEN, GREEN, GREEN, GREEN };
+// 视口导航, 不占用状态机, 任何状态下都可用
+static const char ZOOM_IN_KEY = '+';
+static const char ZOOM_IN_ALT_KEY = '=';
+static const char ZOOM_OUT_KEY = '-';
+static const char HOME_KEY = '0';
+static const char LEFT_KEY = '4';
+static const char RIGHT_KEY = '6';
+static const char UP_KEY = '8';
+static const char DOWN_KEY = '2';
+
+// 性能叠加层, 同样不占用状态机
+static const char STAT_KEY = 'i';
+
+static const float zoom_step = 2.0F;
+static const float pan_step = 0.25F;  // 每次平移视口的四分之一
+
+static const size_t history_budget = 64U * 1024U * 1024U;   // 撤销历史最多占用的内存
+static const size_t stats_capacity = 4096U;                 // 性能记录保留的代数, 保存时导出为 CSV
+static const float sparkline_width = 256.0F;
+static const float sparkline_height = 96.0F;
+
+static const char ordered_keys[] = { AUTO_KEY, STOP_KEY, PACE_KEY, FAST_KEY, JUMP_KEY, EDIT_KEY, UNDO_KEY, REDO_KEY, BACK_KEY, LOAD_KEY, WRTE_KEY, RAND_KEY, RSET_KEY };
+static const uint32_t colors_for_auto[] = { GRAY, GREEN, GRAY, GRAY, GRAY, GRAY, GRAY, GRAY, GRAY, GRAY, GRAY, GRAY, GRAY };
+static const uint32_t colors_for_fast[] = { GRAY, GREEN, GRAY, GRAY, GRAY, GRAY, GRAY, GRAY, GRAY, GRAY, GRAY, GRAY, GRAY };
+static const uint32_t colors_for_stop[]  = { GREEN, GRAY, GREEN, GREEN, GREEN, GREEN, GREEN, GREEN, GREEN, GRAY, GRAY, GRAY, GRAY };
+static const uint32_t colors_for_edit[] = { GREEN, GRAY, GREEN, GREEN, GREEN, GRAY, GREEN, GREEN, GREEN, GREEN, GREEN, GREEN, GREEN };
 
 /*************************************************************************************************/
+JrLab::GameOfLifeWorld::~GameOfLifeWorld() {
+    // 棋盘随舞台一起删除, 后台线程要在棋盘开始析构之前停下
+    if (this->gameboard != nullptr) {
+        this->gameboard->stop_simulation();
+    }
+}
+
 void JrLab::GameOfLifeWorld::load(float width, float height) {
     TheBigBang::load(width, height);
 
@@ -41,20 +77,62 @@ void JrLab::GameOfLifeWorld::load(float width, float height) {
 void JrLab::GameOfLifeWorld::load_gameboard(float width, float height) {
     float board_height = height - this->get_titlebar_height() * 2.0F;
     float board_width = width - this->get_titlebar_height();
-    int col = fl2fxi(board_width / this->gridsize) - 1;
-    int row = fl2fxi(board_height / this->gridsize) - 1;
+    int fit_col = fl2fxi(board_width / this->gridsize) - 1;
+    int fit_row = fl2fxi(board_height / this->gridsize) - 1;
+    int col = (this->options.cols > 0) ? this->options.cols : fit_col;
+    int row = (this->options.rows > 0) ? this->options.rows : fit_row;
+    LifeRule rule = conway_rule;
+    LifeTopology topology = LifeTopology::Dead;
+
+    if (!this->options.rule.empty()) {
+        if (!parse_life_rule(this->options.rule, &rule)) {
+            printf("Invalid rule: %s, fallback to %s\n", this->options.rule.c_str(), life_rule_to_string(rule).c_str());
+        }
+    }
+
+    if (!this->options.topology.empty()) {
+        if (!parse_life_topology(this->options.topology, &topology)) {
+            printf("Invalid topology: %s, fallback to %s\n", this->options.topology.c_str(), life_topology_name(topology));
+        }
+    }
+
+    if ((this->options.jump < 0) || (this->options.jump > hashlife_max_jump)) {
+        printf("Invalid jump: %d, fallback to 0\n", this->options.jump);
+        this->options.jump = 0;
+    }
+
+    this->gameboard = this->insert(make_game_of_lifelet(this->options.engine, rule, row, col, this->gridsize, this->options.jump, topology));
+    this->gameboard->set_thread_count(this->options.threads);
+    this->gameboard->set_cycle_detection(true);
+    this->gameboard->set_history_budget(history_budget);
+    this->gameboard->set_instrument_capacity(stats_capacity);
+
+    // 窗口只是观察宇宙的视口, 宇宙比窗口大时才需要平移和缩放
+    this->view_width = float(fxmin(col, fit_col)) * this->gridsize;
+    this->view_height = float(fxmin(row, fit_row)) * this->gridsize;
+    this->gameboard->set_viewport(this->view_width, this->view_height);
 
-    this->gameboard = this->spawn<ConwayLifelet>(row, col, this->gridsize);
     this->generation = this->spawn<Labellet>(GameFont::math(), GREEN, generation_fmt, this->gameboard->get_generation());
+
+    // 叠加层默认隐藏, 按键才显示
+    this->sparkline = this->insert(new LifeSparklet(this->gameboard, sparkline_width, sparkline_height));
+    this->stats = this->spawn<Labellet>(GameFont::monospace(), GOLD, stats_fmt, 0.0, 0.0, 0.0, 0LL, 0LL, 0LL);
+    this->sparkline->show(false);
+    this->stats->show(false);
 }
 
 void JrLab::GameOfLifeWorld::load_instructions(float width, float height) {
     this->instructions[AUTO_KEY] = this->spawn<Labellet>(GameFont::monospace(), "%c. 自行演化", AUTO_KEY);
     this->instructions[STOP_KEY] = this->spawn<Labellet>(GameFont::monospace(), "%c. 停止演化", STOP_KEY);
     this->instructions[EDIT_KEY] = this->spawn<Labellet>(GameFont::monospace(), "%c. 手动编辑", EDIT_KEY);
+    this->instructions[UNDO_KEY] = this->spawn<Labellet>(GameFont::monospace(), "%c. 撤销", UNDO_KEY);
+    this->instructions[REDO_KEY] = this->spawn<Labellet>(GameFont::monospace(), "%c. 重做", REDO_KEY);
+    this->instructions[BACK_KEY] = this->spawn<Labellet>(GameFont::monospace(), "%c. 倒退 %lld 代", BACK_KEY, this->options.leap);
     this->instructions[RAND_KEY] = this->spawn<Labellet>(GameFont::monospace(), "%c. 随机重建", RAND_KEY);
     this->instructions[RSET_KEY] = this->spawn<Labellet>(GameFont::monospace(), "%c. 世界归零", RSET_KEY);
     this->instructions[PACE_KEY] = this->spawn<Labellet>(GameFont::monospace(), "%c. 单步跟踪", PACE_KEY);
+    this->instructions[FAST_KEY] = this->spawn<Labellet>(GameFont::monospace(), "%c. 全速演化", FAST_KEY);
+    this->instructions[JUMP_KEY] = this->spawn<Labellet>(GameFont::monospace(), "%c. 跳过 %lld 代", JUMP_KEY, this->options.leap);
     this->instructions[LOAD_KEY] = this->spawn<Labellet>(GameFont::monospace(), "%c. 载入范例", LOAD_KEY);
     this->instructions[WRTE_KEY] = this->spawn<Labellet>(GameFont::monospace(), "%c. 保存范例", WRTE_KEY);
 }
@@ -64,6 +142,8 @@ void JrLab::GameOfLifeWorld::reflow(float width, float height) {
 
     this->move_to(this->gameboard, { width * 0.5F, (height + this->get_titlebar_height()) * 0.5F }, MatterPort::CC);
     this->move_to(this->generation, { this->gameboard, MatterPort::RT }, MatterPort::RB);
+    this->move_to(this->sparkline, { this->gameboard, MatterPort::LT }, MatterPort::LT, { 8.0F, 8.0F });
+    this->move_to(this->stats, { this->sparkline, MatterPort::LB }, MatterPort::LT, { 0.0F, 4.0F });
 
     this->move_to(this->instructions[ordered_keys[0]], { 0.0F, height }, MatterPort::LB);
     for (int idx = 1; idx < sizeof(ordered_keys) / sizeof(char); idx ++) {
@@ -80,6 +160,19 @@ void JrLab::GameOfLifeWorld::on_mission_start(float width, float height) {
 void JrLab::GameOfLifeWorld::update(uint64_t count, uint32_t interval, uint64_t uptime) {
     if (this->state == GameState::Auto) {
         this->pace_forward();
+    } else if (this->state == GameState::Fast) {
+        // 后台线程自己全速演化, 这里只按帧率取回最新的快照
+        bool running = this->gameboard->sync_simulation();
+
+        this->show_generation(false);
+
+        if (!running) {
+            this->switch_game_state(GameState::Stop);
+        }
+    }
+
+    if (this->stats->visible()) {
+        this->show_stats();
     }
 }
 
@@ -111,7 +204,11 @@ void JrLab::GameOfLifeWorld::on_tap(IMatter* matter, float x, float y) {
 
 void JrLab::GameOfLifeWorld::on_char(char key, uint16_t modifiers, uint8_t repeats, bool pressed) {
     if (!pressed) {
-        if (this->instructions.find(key) != this->instructions.end()) {
+        if (this->on_navigate(key)) {
+            this->notify_updated();
+        } else if (key == STAT_KEY) {
+            this->toggle_stats();
+        } else if (this->instructions.find(key) != this->instructions.end()) {
             if (this->instructions[key]->get_foreground_color() == GREEN) {
                 switch(key) {
                 case AUTO_KEY: this->switch_game_state(GameState::Auto); break;
@@ -120,6 +217,19 @@ void JrLab::GameOfLifeWorld::on_char(char key, uint16_t modifiers, uint8_t repea
                 case RAND_KEY: this->agent->play_writing(1); this->gameboard->construct_random_world(); break;
                 case RSET_KEY: this->agent->play_empty_trash(1); this->gameboard->reset(); break;
                 case PACE_KEY: this->agent->play_processing(1); this->pace_forward(); break;
+                case FAST_KEY: this->gameboard->start_simulation(); this->switch_game_state(GameState::Fast); break;
+                case JUMP_KEY: {
+                    this->gameboard->start_simulation(this->gameboard->get_generation() + this->options.leap);
+                    this->switch_game_state(GameState::Fast);
+                }; break;
+                case UNDO_KEY: this->gameboard->undo(); this->show_generation(false); break;
+                case REDO_KEY: this->gameboard->redo(); this->show_generation(false); break;
+                case BACK_KEY: {
+                    long long target = this->gameboard->get_generation() - this->options.leap;
+
+                    this->gameboard->rewind((target > 0) ? target : 0);
+                    this->show_generation(false);
+                }; break;
                 case LOAD_KEY: this->agent->play_searching(1); this->load_conway_demo(); break;
                 case WRTE_KEY: this->agent->play_print(1); this->save_conway_demo(); break;
                 }
@@ -132,25 +242,87 @@ void JrLab::GameOfLifeWorld::on_char(char key, uint16_t modifiers, uint8_t repea
     }
 }
 
+bool JrLab::GameOfLifeWorld::on_navigate(char key) {
+    bool handled = true;
+
+    switch (key) {
+    case ZOOM_IN_KEY: case ZOOM_IN_ALT_KEY: this->gameboard->zoom(zoom_step); break;
+    case ZOOM_OUT_KEY: this->gameboard->zoom(1.0F / zoom_step); break;
+    case HOME_KEY: this->gameboard->reset_view(); break;
+    case LEFT_KEY: this->gameboard->pan(-this->view_width * pan_step, 0.0F); break;
+    case RIGHT_KEY: this->gameboard->pan(this->view_width * pan_step, 0.0F); break;
+    case UP_KEY: this->gameboard->pan(0.0F, -this->view_height * pan_step); break;
+    case DOWN_KEY: this->gameboard->pan(0.0F, this->view_height * pan_step); break;
+    default: handled = false;
+    }
+
+    return handled;
+}
+
+void JrLab::GameOfLifeWorld::toggle_stats() {
+    bool yes = !this->stats->visible();
+
+    this->sparkline->show(yes);
+    this->stats->show(yes);
+
+    if (yes) {
+        this->show_stats();
+    }
+
+    this->notify_updated();
+}
+
 void JrLab::GameOfLifeWorld::on_save(const std::string& life_world, std::ofstream& golout) {
     this->gameboard->save(life_world, golout);
+    this->save_stats(life_world);
 }
 
 /*************************************************************************************************/
 void JrLab::GameOfLifeWorld::pace_forward() {
-    if (this->gameboard->pace_forward()) {
-        this->generation->set_text_color(GREEN);
-        this->generation->set_text(MatterPort::RB, generation_fmt, this->gameboard->get_generation());
-    } else {
-        this->generation->set_text_color(ORANGE);
-        this->generation->set_text(MatterPort::RB, generation_fmt, this->gameboard->get_generation());
-        
+    bool evolved = this->gameboard->pace_forward();
+    int period = this->gameboard->get_period();
+
+    this->show_generation(!evolved);
+
+    // 循环被打破之后, 下一次确认的循环又值得停下来看看
+    if (period == 0) {
+        this->stop_on_cycle = true;
+    }
+
+    // 停滞或者刚进入循环, 再演化下去也只是重复, 自动演化就此停下; 再按一次自动演化就不再因为这个循环停下
+    if ((!evolved) || (this->stop_on_cycle && (period > 0))) {
         if (this->state == GameState::Auto) {
             this->switch_game_state(GameState::Stop);
         }
     }
 }
 
+void JrLab::GameOfLifeWorld::show_generation(bool stalled) {
+    int period = this->gameboard->get_period();
+
+    if (period == 0) {
+        this->generation->set_text_color(stalled ? ORANGE : GREEN);
+        this->generation->set_text(MatterPort::RB, generation_fmt, this->gameboard->get_generation());
+    } else {
+        this->generation->set_text_color(ORANGE);
+        this->generation->set_text(MatterPort::RB, cycle_fmt, this->gameboard->get_generation(), period);
+    }
+}
+
+void JrLab::GameOfLifeWorld::show_stats() {
+    std::vector<LifeGenerationSample> latest;
+
+    if (this->gameboard->get_instrument().recent(latest, 1U) > 0U) {
+        const LifeGenerationSample& s = latest[0];
+
+        this->stats->set_text(MatterPort::LT, stats_fmt,
+            double(s.evolve_ns) * 1e-6, double(s.sync_ns) * 1e-6, double(s.draw_ns) * 1e-6,
+            s.population, s.births, s.deaths);
+    }
+
+    this->notify_updated(this->sparkline);
+}
+
 void JrLab::GameOfLifeWorld::load_conway_demo() {
     if (!exists(this->demo_path)) {
         this->demo_path = DEFAULT_CONWAY_DEMO;
@@ -161,7 +333,15 @@ void JrLab::GameOfLifeWorld::load_conway_demo() {
 
         golin.exceptions(std::ios_base::badbit | std::ios_base::failbit);
         golin.open(this->demo_path);
-        this->gameboard->load(this->demo_path, golin);
+
+        this->rle_demo = is_life_rle(this->demo_path, golin);
+
+        if (this->rle_demo) {
+            this->gameboard->load_rle(this->demo_path, golin);
+        } else {
+            this->gameboard->load(this->demo_path, golin);
+        }
+
         golin.close();
     } catch (std::ifstream::failure &e) {
         this->instructions[LOAD_KEY]->set_text_color(FIREBRICK);
@@ -179,8 +359,16 @@ void JrLab::GameOfLifeWorld::save_conway_demo() {
 
         golout.exceptions(std::ios_base::badbit | std::ios_base::failbit);
         golout.open(this->demo_path);
-        this->gameboard->save(this->demo_path, golout);
+
+        // 按载入时的格式写回
+        if (this->rle_demo) {
+            this->gameboard->save_rle(this->demo_path, golout);
+        } else {
+            this->gameboard->save(this->demo_path, golout);
+        }
+
         golout.close();
+        this->save_stats(this->demo_path);
         this->instructions[WRTE_KEY]->set_text_color(ROYALBLUE);
     } catch (std::ifstream::failure &e) {
         this->instructions[WRTE_KEY]->set_text_color(FIREBRICK);
@@ -188,16 +376,43 @@ void JrLab::GameOfLifeWorld::save_conway_demo() {
     }
 }
 
+void JrLab::GameOfLifeWorld::save_stats(const std::string& life_world) {
+    // 性能记录写在范例旁边, 同名, 扩展名换成 .csv
+    if (this->gameboard->get_instrument().size() > 0U) {
+        path csv_path = path(life_world).replace_extension(".csv");
+        std::ofstream csv(csv_path);
+
+        if (csv.is_open()) {
+            this->gameboard->get_instrument().write_csv(csv);
+        } else {
+            printf("Failed to save the statistics: %s\n", csv_path.string().c_str());
+        }
+    }
+}
+
 /*************************************************************************************************/
 void JrLab::GameOfLifeWorld::switch_game_state(GameState new_state) {
     if (this->state != new_state) {
+        // 离开全速演化时先停下后台线程, 之后棋盘又可以直接编辑了
+        if (this->state == GameState::Fast) {
+            this->gameboard->stop_simulation();
+            this->show_generation(false);
+        }
+
         switch (new_state) {
         case GameState::Auto: {
+            this->stop_on_cycle = (this->gameboard->get_period() == 0);
             this->gameboard->set_color(LIGHTSKYBLUE);
             this->gameboard->show_grid(false);
             this->agent->play_thinking(8);
             this->update_instructions_state(colors_for_auto);
         }; break;
+        case GameState::Fast: {
+            this->gameboard->set_color(LIGHTSKYBLUE);
+            this->gameboard->show_grid(false);
+            this->agent->play_thinking(8);
+            this->update_instructions_state(colors_for_fast);
+        }; break;
         case GameState::Stop: {
             this->gameboard->set_color(DIMGRAY);
             this->agent->play_rest_pose(1);
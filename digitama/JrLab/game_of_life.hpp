@@ -3,19 +3,32 @@
 #include <plteen/bang.hpp>
 
 #include "conway/lifelet.hpp"
+#include "conway/sparklet.hpp"
 
 #include <map>
 
 namespace JrLab {
-    enum class GameState { Auto, Stop, Edit, _ };
+    enum class GameState { Auto, Fast, Stop, Edit, _ };
+
+    struct GameOfLifeOptions {
+        std::string demo;       // 范例文件
+        std::string engine;     // 演化引擎: bitwise, hashlife, 留空则为默认的 int 矩阵
+        std::string rule;       // B/S 规则串或常用规则的名字, 留空则为 B3/S23
+        std::string topology;   // 边界拓扑: dead, torus, klein, 留空则为 dead
+        int jump = 0;           // hashlife 每一步演化 2^jump 代
+        int threads = 1;        // 并行演化的线程数, 0 表示使用所有的 CPU 核
+        long long leap = 1000;  // 跳跃键一次在后台向前演化的代数
+        int rows = 0;           // 宇宙的大小, 0 表示刚好铺满窗口; 更大的宇宙通过视口平移和缩放观察
+        int cols = 0;
+    };
 
     /** 声明游戏宇宙 **/
     class GameOfLifeWorld : public Plteen::TheBigBang {
     public:
-        GameOfLifeWorld(float gridsize = 8.0F) : GameOfLifeWorld("", gridsize) {}
-        GameOfLifeWorld(const std::string& life_demo, float gridsize = 8.0F)
-            : TheBigBang("生命游戏"), demo_path(life_demo), gridsize(gridsize) {}
-        virtual ~GameOfLifeWorld() {}
+        GameOfLifeWorld(float gridsize = 8.0F) : GameOfLifeWorld(GameOfLifeOptions(), gridsize) {}
+        GameOfLifeWorld(const JrLab::GameOfLifeOptions& options, float gridsize = 8.0F)
+            : TheBigBang("生命游戏"), options(options), demo_path(options.demo), gridsize(gridsize) {}
+        virtual ~GameOfLifeWorld();
 
     public:    // 覆盖游戏基本方法
         void load(float width, float height) override;
@@ -28,6 +41,8 @@ namespace JrLab {
             
     protected: // 覆盖输入事件处理方法
         void on_char(char key, uint16_t modifiers, uint8_t repeats, bool pressed) override; // 处理键盘事件
+        bool on_navigate(char key);
+        void toggle_stats();
         void on_tap(Plteen::IMatter* m, float x, float y) override;                  // 处理鼠标事件
 
     protected: // 处理保存事件
@@ -40,19 +55,29 @@ namespace JrLab {
         void switch_game_state(JrLab::GameState new_state);
         void update_instructions_state(const uint32_t* colors);
         void pace_forward();
+        void show_generation(bool stalled);
+        void show_stats();
         void load_conway_demo();
         void save_conway_demo();
+        void save_stats(const std::string& life_world);
             
     private: // 游戏物体
         Plteen::Labellet* generation;
-        JrLab::GameOfLifelet* gameboard;
+        JrLab::GameOfLifelet* gameboard = nullptr;
+        JrLab::LifeSparklet* sparkline = nullptr;
+        Plteen::Labellet* stats = nullptr;
         std::map<char, Plteen::Labellet*> instructions;
 
     private: // 游戏状态
         JrLab::GameState state = GameState::_;
+        bool stop_on_cycle = true;  // 自动演化确认循环时是否停下, 已经停过一次的循环不再停
 
     private:
+        JrLab::GameOfLifeOptions options;
         std::string demo_path;
+        bool rle_demo = false;
         float gridsize;
+        float view_width = 0.0F;
+        float view_height = 0.0F;
     };
 }
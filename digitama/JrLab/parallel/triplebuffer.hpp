@@ -0,0 +1,50 @@
+#pragma once // 确保只被 include 一次
+
+#include <atomic>
+
+namespace JrLab {
+    /**
+     * 单生产者单消费者的无锁三缓冲
+     * 生产者总是写 back, 写完 publish 把它和中间那块交换;
+     * 消费者 acquire 时若中间那块是新的, 就把它和 front 交换, 之后一直读 front;
+     * 双方各自独占一块, 任何时候都不会等待对方, 消费者也总能拿到最近一次发布的内容
+     */
+    template<typename T>
+    class TripleBuffer {
+    public:
+        TripleBuffer() {}
+
+    public:
+        T& back() { return this->slots[this->back_idx]; }
+        T& front() { return this->slots[this->front_idx]; }
+        T& at(int idx) { return this->slots[idx]; }     // 只能在没有其他线程使用时调用, 比如初始化
+
+    public:
+        void publish() {
+            this->back_idx = this->middle.exchange(this->back_idx | fresh_bit, std::memory_order_acq_rel) & index_mask;
+        }
+
+        bool acquire() {
+            bool fresh = ((this->middle.load(std::memory_order_relaxed) & fresh_bit) != 0);
+
+            if (fresh) {
+                this->front_idx = this->middle.exchange(this->front_idx, std::memory_order_acq_rel) & index_mask;
+            }
+
+            return fresh;
+        }
+
+    public:
+        static const int size = 3;
+
+    private:
+        static const int index_mask = 0x3;
+        static const int fresh_bit = 0x4;
+
+    private:
+        T slots[size];
+        int back_idx = 0;
+        int front_idx = 1;
+        std::atomic<int> middle { 2 };
+    };
+}
@@ -0,0 +1,130 @@
+#include "workpool.hpp"
+
+using namespace JrLab;
+
+/*************************************************************************************************/
+JrLab::WorkPool::WorkPool(int size) : pending(0) {
+    if (size <= 0) {
+        size = int(std::thread::hardware_concurrency());
+    }
+
+    this->worker_count = (size > 0) ? size : 1;
+    this->queues = new WorkQueue[this->worker_count];
+
+    // 0 号工人是调用 run 的线程
+    for (int id = 1; id < this->worker_count; id ++) {
+        this->workers.emplace_back(&WorkPool::work, this, id);
+    }
+}
+
+JrLab::WorkPool::~WorkPool() {
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+
+        this->stopping = true;
+        this->wakeup.notify_all();
+    }
+
+    for (auto& worker : this->workers) {
+        worker.join();
+    }
+
+    delete [] this->queues;
+}
+
+void JrLab::WorkPool::run(int task_count, const std::function<void(int)>& task) {
+    if ((this->worker_count == 1) || (task_count <= 1)) {
+        for (int idx = 0; idx < task_count; idx ++) {
+            task(idx);
+        }
+    } else if (task_count > 0) {
+        {
+            std::lock_guard<std::mutex> guard(this->lock);
+
+            this->job = &task;
+            this->pending = task_count;
+
+            for (int idx = 0; idx < task_count; idx ++) {
+                WorkQueue& q = this->queues[idx % this->worker_count];
+                std::lock_guard<std::mutex> qguard(q.lock);
+
+                q.tasks.push_back(idx);
+            }
+
+            this->epoch ++;
+            this->wakeup.notify_all();
+        }
+
+        this->drain(0);
+
+        /* 等待别的工人做完手里的任务 */ {
+            std::unique_lock<std::mutex> guard(this->lock);
+
+            this->done.wait(guard, [this] { return this->pending.load() == 0; });
+            this->job = nullptr;
+        }
+    }
+}
+
+/*************************************************************************************************/
+void JrLab::WorkPool::work(int id) {
+    uint64_t seen = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> guard(this->lock);
+
+            this->wakeup.wait(guard, [this, seen] { return this->stopping || (this->epoch != seen); });
+
+            if (this->stopping) {
+                break;
+            }
+
+            seen = this->epoch;
+        }
+
+        this->drain(id);
+    }
+}
+
+void JrLab::WorkPool::drain(int id) {
+    int task;
+
+    while (this->take(id, &task)) {
+        (*this->job)(task);
+
+        if (this->pending.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> guard(this->lock);
+
+            this->done.notify_all();
+        }
+    }
+}
+
+bool JrLab::WorkPool::take(int id, int* task) {
+    // 先做自己的
+    {
+        WorkQueue& q = this->queues[id];
+        std::lock_guard<std::mutex> guard(q.lock);
+
+        if (!q.tasks.empty()) {
+            (*task) = q.tasks.front();
+            q.tasks.pop_front();
+            return true;
+        }
+    }
+
+    // 再从别人的队尾偷
+    for (int k = 1; k < this->worker_count; k ++) {
+        WorkQueue& q = this->queues[(id + k) % this->worker_count];
+        std::lock_guard<std::mutex> guard(q.lock);
+
+        if (!q.tasks.empty()) {
+            (*task) = q.tasks.back();
+            q.tasks.pop_back();
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,51 @@
+#pragma once // 确保只被 include 一次
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace JrLab {
+    /**
+     * 常驻线程池
+     * 每一批任务按编号轮流分到各个线程的队列里, 自己的队列做完之后就去别人的队尾偷任务;
+     * 调用 run 的线程也算一个工人, run 返回时整批任务都已完成
+     */
+    class WorkPool {
+    public:
+        WorkPool(int size = 0);     // size 为 0 时使用所有的 CPU 核
+        virtual ~WorkPool();
+
+    public:
+        void run(int task_count, const std::function<void(int)>& task);
+        int size() { return this->worker_count; }
+
+    private:
+        struct WorkQueue {
+            std::mutex lock;
+            std::deque<int> tasks;
+        };
+
+    private:
+        void work(int id);
+        void drain(int id);
+        bool take(int id, int* task);
+
+    private:
+        std::vector<std::thread> workers;
+        WorkQueue* queues;
+        int worker_count;
+
+    private:
+        std::mutex lock;
+        std::condition_variable wakeup;
+        std::condition_variable done;
+        const std::function<void(int)>* job = nullptr;
+        std::atomic<int> pending;
+        uint64_t epoch = 0;
+        bool stopping = false;
+    };
+}
@@ -0,0 +1,138 @@
+#include "stream.hpp"
+
+#include <random>
+#include <utility>
+
+using namespace JrLab;
+
+/*************************************************************************************************/
+static inline uint64_t splitmix64(uint64_t& x) {
+    uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+    return z ^ (z >> 31);
+}
+
+static inline uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t entropy_seed() {
+    std::random_device entropy;
+
+    return (uint64_t(entropy()) << 32U) | uint64_t(entropy());
+}
+
+// FNV-1a
+static inline uint64_t name_hash(const char* name) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+
+    for (const char* ch = name; (*ch) != '\0'; ch ++) {
+        hash = (hash ^ uint64_t(uint8_t(*ch))) * 0x100000001B3ULL;
+    }
+
+    return hash;
+}
+
+static uint64_t master_seed = 0U;
+static bool master_seeded = false;
+
+/*************************************************************************************************/
+void JrLab::set_random_master_seed(uint64_t seed) {
+    master_seed = seed;
+    master_seeded = true;
+}
+
+bool JrLab::random_master_seed(uint64_t* seed) {
+    if (master_seeded && (seed != nullptr)) {
+        (*seed) = master_seed;
+    }
+
+    return master_seeded;
+}
+
+/*************************************************************************************************/
+JrLab::RandomStream::RandomStream() {
+    this->reseed(entropy_seed());
+}
+
+JrLab::RandomStream::RandomStream(const char* world) {
+    uint64_t seed = 0U;
+
+    if (!random_master_seed(&seed)) {
+        seed = entropy_seed();
+    }
+
+    this->reseed(seed, name_hash(world));
+}
+
+void JrLab::RandomStream::reseed(uint64_t seed, uint64_t stream) {
+    uint64_t x = seed ^ (stream * 0xD1B54A32D192ED03ULL);
+
+    for (int idx = 0; idx < 4; idx ++) {
+        this->state[idx] = splitmix64(x);
+    }
+}
+
+RandomStream JrLab::RandomStream::fork() {
+    return RandomStream(this->next());
+}
+
+uint64_t JrLab::RandomStream::next() {
+    uint64_t result = rotl(this->state[1] * 5ULL, 7) * 9ULL;
+    uint64_t t = this->state[1] << 17;
+
+    this->state[2] ^= this->state[0];
+    this->state[3] ^= this->state[1];
+    this->state[1] ^= this->state[2];
+    this->state[0] ^= this->state[3];
+    this->state[2] ^= t;
+    this->state[3] = rotl(this->state[3], 45);
+
+    return result;
+}
+
+int JrLab::RandomStream::uniform(int lo, int hi) {
+    if (hi < lo) {
+        std::swap(lo, hi);
+    }
+
+    // 高 32 位乘以区间长度再取高位, 区间远小于 2^32, 偏差可以忽略
+    uint64_t span = uint64_t(int64_t(hi) - int64_t(lo) + 1);
+
+    return int(int64_t(lo) + int64_t(((this->next() >> 32U) * span) >> 32U));
+}
+
+void JrLab::RandomStream::fill(uint64_t* dest, size_t n) {
+    for (size_t idx = 0; idx < n; idx ++) {
+        dest[idx] = this->next();
+    }
+}
+
+void JrLab::RandomStream::fill_uniform(int* dest, size_t n, int lo, int hi) {
+    if (hi < lo) {
+        std::swap(lo, hi);
+    }
+
+    uint64_t span = uint64_t(int64_t(hi) - int64_t(lo) + 1);
+
+    // 小区间(比如方向和基因)一个 64 位的字拆成四份用, 相对偏差不超过 span / 2^16
+    if (span <= 0x100ULL) {
+        size_t idx = 0;
+
+        while (idx < n) {
+            uint64_t word = this->next();
+
+            for (int lane = 0; (lane < 4) && (idx < n); lane ++, idx ++) {
+                dest[idx] = int(int64_t(lo) + int64_t(((word & 0xFFFFULL) * span) >> 16U));
+                word >>= 16U;
+            }
+        }
+    } else {
+        for (size_t idx = 0; idx < n; idx ++) {
+            dest[idx] = this->uniform(lo, hi);
+        }
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once // 确保只被 include 一次
+
+#include <cstddef>
+#include <cstdint>
+
+namespace JrLab {
+    /**
+     * 可播种的随机数流(xoshiro256**), 每个世界, 每个实体各用各的, 多线程同时模拟时互不干扰
+     * 同一个种子的不同流号得到互不相关的序列; 按名字构造的世界流从总种子派生,
+     * 命令行给了总种子(--seed)就能完整重放, 否则用系统熵源随机播种
+     */
+    class RandomStream {
+    public:
+        RandomStream();
+        RandomStream(uint64_t seed, uint64_t stream = 0U) { this->reseed(seed, stream); }
+        explicit RandomStream(const char* world);   // 世界流, 流号是名字的哈希
+
+    public:
+        void reseed(uint64_t seed, uint64_t stream = 0U);
+        RandomStream fork();    // 派生一条独立的子流, 比如分给新生的实体, 本流前进一步
+
+    public:
+        uint64_t next();
+        int uniform(int lo, int hi);    // [lo, hi] 里的整数, 和 random_uniform 一样两端都包括, 两端给反了就先交换
+
+    public: // 批量生成
+        void fill(uint64_t* dest, size_t n);
+        void fill_uniform(int* dest, size_t n, int lo, int hi);
+
+    private:
+        uint64_t state[4];
+    };
+
+    // 整个程序的总种子, 设定之后新构造的世界流都由它派生
+    void set_random_master_seed(uint64_t seed);
+    bool random_master_seed(uint64_t* seed);
+}
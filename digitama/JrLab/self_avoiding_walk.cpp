@@ -23,7 +23,7 @@ static inline bool is_inside_maze(int row, int col) {
              && (col >= 1) && (col < (MAZE_SIZE - 1)));
 }
 
-static void backtracking_pace(bool maze[MAZE_SIZE][MAZE_SIZE], int& row, int& col) {
+static void backtracking_pace(bool maze[MAZE_SIZE][MAZE_SIZE], int& row, int& col, RandomStream& random) {
     int btr = row;
     int btc = col;
 
@@ -31,7 +31,7 @@ static void backtracking_pace(bool maze[MAZE_SIZE][MAZE_SIZE], int& row, int& co
         row = btr;
         col = btc;
 
-        switch (random_uniform(0, 3) % 4) {
+        switch (random.uniform(0, 3)) {
             case 0: row -= 1; break;
             case 1: col -= 1; break;
             case 2: row += 1; break;
@@ -110,7 +110,7 @@ void JrLab::SelfAvoidingWalkWorld::update(uint64_t count, uint32_t interval, uin
                         int cur_r = this->row;
                         int cur_c = this->col;
 
-                        backtracking_pace(this->maze, this->row, this->col);
+                        backtracking_pace(this->maze, this->row, this->col, this->random);
                         this->maze[this->row][this->col] = true;
                         this->glide(pace_duration, this->walker,
                                         { float(this->col - cur_c) * this->cell_region.width(),
@@ -2,6 +2,8 @@
 
 #include <plteen/bang.hpp>
 
+#include "random/stream.hpp"
+
 namespace JrLab {
 #define MAZE_SIZE 15    // 方格单边数量
 
@@ -33,6 +35,7 @@ namespace JrLab {
     private:
         bool maze[MAZE_SIZE][MAZE_SIZE];
         Plteen::Box cell_region;
+        JrLab::RandomStream random { "self-avoiding walk" };
 
     private:
         Plteen::Bracer* walker = nullptr;